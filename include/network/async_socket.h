@@ -0,0 +1,88 @@
+#ifndef __SK_NETWORK_ASYNC_SOCKET_H__
+#define __SK_NETWORK_ASYNC_SOCKET_H__
+
+#include <network/event_loop.h>
+#include <network/stream_socket.h>
+#include <utilities/task.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace SK {
+
+/*
+    AsyncSocket -- a non-blocking StreamSocket driven by an EventLoop.
+    Instead of blocking a thread, an operation suspends the awaiting
+    coroutine until the socket is ready.
+*/
+class AsyncSocket {
+public:
+    /* Cheap counters of the traffic -- only touched by the thread of the loop. */
+    struct Counters {
+        std::uint64_t bytes_in = 0;
+        std::uint64_t bytes_out = 0;
+        std::uint64_t receives = 0;     // recv() calls, including those which found nothing to read
+        std::uint64_t sends = 0;        // send() and sendfile() calls
+        std::uint64_t short_writes = 0; // sends which did not take the whole buffer
+        std::uint64_t would_block = 0;  // sends which took nothing, as the buffer was full
+    };
+
+private:
+    constexpr static unsigned MAX_IMMEDIATE_READS = 16;
+
+    StreamSocket socket;
+    EventLoop *event_loop;
+    Counters io{};
+    unsigned immediate_reads = 0;   // reads in a row which have not waited for the loop
+
+public:
+    AsyncSocket(StreamSocket &&socket_, EventLoop &event_loop_);
+
+    AsyncSocket(AsyncSocket&&) = default;
+    AsyncSocket &operator=(AsyncSocket&&) = default;
+
+    AsyncSocket(const AsyncSocket&) = delete;
+    AsyncSocket &operator=(const AsyncSocket&) = delete;
+
+    ~AsyncSocket();
+
+    /* Returns the number of bytes read -- 0 if the peer has closed the connection or the read has been cancelled. */
+    Task<std::size_t> read_some(std::span<std::byte> span);
+    /* As read_some(), but gives up at the deadline -- returns std::nullopt then. */
+    Task<std::optional<std::size_t>> read_some_until(std::span<std::byte> span, EventLoop::Clock::time_point deadline);
+    /* Returns false if the write has been cancelled. */
+    Task<bool> write_all(std::span<std::byte> span);
+    /* As write_all(), for count bytes of the file at the offset. */
+    Task<bool> write_file(int file_fd, std::uint64_t offset, std::size_t count);
+
+    /* Wakes up all the pending operations. */
+    void cancel();
+
+    /*
+        Gives the socket up, e.g. to be passed to another process: the pending
+        operations are cancelled, and any later one fails rather than touching it.
+    */
+    StreamSocket release();
+
+    const Counters &counters() const {
+        return io;
+    }
+
+    EventLoop &loop() const {
+        return *event_loop;
+    }
+
+    const StreamSocket &get() const {
+        return socket;
+    }
+
+private:
+    Task<void> yield_if_busy();
+    std::optional<std::size_t> try_read(std::span<std::byte> span);
+};
+
+} // namespace SK
+
+#endif // __SK_NETWORK_ASYNC_SOCKET_H__
@@ -0,0 +1,232 @@
+#ifndef __SK_NETWORK_EVENT_LOOP_H__
+#define __SK_NETWORK_EVENT_LOOP_H__
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <functional>   // std::greater
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace SK {
+
+/*
+    EventLoop -- an epoll-based reactor resuming coroutines once
+    the file descriptors they wait for become ready.
+
+    The deadlines are kept by a timerfd with the resolution of the clock,
+    not the milliseconds of epoll_wait(), so that a coroutine sleeping until
+    the end of a turn is woken up right at it.
+
+    Waiting for readiness or for a deadline and cancelling waits must happen
+    in the thread running the loop. post(), schedule() and stop() can be
+    used from any thread.
+*/
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Interest {
+        READ,
+        WRITE
+    };
+
+    enum class Readiness {
+        READY,
+        TIMED_OUT,
+        CANCELLED
+    };
+
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        bool cancelled = false;
+        bool timed_out = false;
+        std::uint64_t deadline = 0;     // the id of its deadline, 0 if it has none
+    };
+
+    class ReadinessAwaiter {
+    protected:
+        EventLoop &loop;
+        const int fd;
+        const Interest interest;
+        const std::optional<Clock::time_point> deadline;
+        Waiter waiter{};
+
+    public:
+        ReadinessAwaiter(EventLoop &loop_, int fd_, Interest interest_, std::optional<Clock::time_point> deadline_ = std::nullopt)
+        : loop{loop_}
+        , fd{fd_}
+        , interest{interest_}
+        , deadline{deadline_} {}
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            waiter.handle = handle;
+            loop.watch(fd, interest, waiter);
+            if (deadline)
+                loop.expire(fd, interest, waiter, *deadline);
+        }
+
+        /* Returns false if the wait has been cancelled. */
+        bool await_resume() const noexcept {
+            return !waiter.cancelled;
+        }
+    };
+
+    /* Waits for readiness until a deadline -- and tells which came first. */
+    class DeadlineAwaiter : public ReadinessAwaiter {
+    public:
+        using ReadinessAwaiter::ReadinessAwaiter;
+
+        Readiness await_resume() const noexcept {
+            if (waiter.cancelled)
+                return Readiness::CANCELLED;
+            return waiter.timed_out ? Readiness::TIMED_OUT : Readiness::READY;
+        }
+    };
+
+    class SleepAwaiter {
+    private:
+        EventLoop &loop;
+        const Clock::time_point deadline;
+
+    public:
+        SleepAwaiter(EventLoop &loop_, Clock::time_point deadline_)
+        : loop{loop_}
+        , deadline{deadline_} {}
+
+        bool await_ready() const {
+            return deadline <= Clock::now();
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            loop.timers.push(Timer{deadline, handle});
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    /* Moves the awaiting coroutine over to the thread running the loop. */
+    class ScheduleAwaiter {
+    private:
+        EventLoop &loop;
+
+    public:
+        ScheduleAwaiter(EventLoop &loop_)
+        : loop{loop_} {}
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            loop.post(handle);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+private:
+    struct Timer {
+        Clock::time_point deadline;
+        std::coroutine_handle<> handle;
+        // Set for the deadline of a readiness wait, which is void once the descriptor has become ready.
+        std::uint64_t id = 0;
+        int fd = -1;
+        Interest interest = Interest::READ;
+
+        bool operator>(const Timer &other) const {
+            return deadline > other.deadline;
+        }
+    };
+
+    struct Watch {
+        Waiter *reader = nullptr;
+        Waiter *writer = nullptr;
+        unsigned registered = 0;
+    };
+
+    int epoll_fd = -1;
+    int wake_fd = -1;
+    int timer_fd = -1;
+
+    std::unordered_map<int, Watch> watches{};
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers{};
+    std::optional<Clock::time_point> armed = std::nullopt;
+
+    std::unordered_map<std::uint64_t, Waiter*> deadlines{};
+    std::uint64_t next_deadline = 1;
+
+    std::mutex posted_mutex{};
+    std::vector<std::coroutine_handle<>> posted{};
+
+    std::atomic_bool stopped = false;
+
+    constexpr static int MAX_EVENTS = 256;
+
+public:
+    EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop &operator=(const EventLoop&) = delete;
+
+    EventLoop(EventLoop&&) = delete;
+    EventLoop &operator=(EventLoop&&) = delete;
+
+    ~EventLoop();
+
+    ReadinessAwaiter readable(int fd) {
+        return ReadinessAwaiter{*this, fd, Interest::READ};
+    }
+
+    ReadinessAwaiter writable(int fd) {
+        return ReadinessAwaiter{*this, fd, Interest::WRITE};
+    }
+
+    DeadlineAwaiter readable_until(int fd, Clock::time_point deadline) {
+        return DeadlineAwaiter{*this, fd, Interest::READ, deadline};
+    }
+
+    DeadlineAwaiter writable_until(int fd, Clock::time_point deadline) {
+        return DeadlineAwaiter{*this, fd, Interest::WRITE, deadline};
+    }
+
+    SleepAwaiter sleep_until(Clock::time_point deadline) {
+        return SleepAwaiter{*this, deadline};
+    }
+
+    ScheduleAwaiter schedule() {
+        return ScheduleAwaiter{*this};
+    }
+
+    /* Resumes everything waiting for the descriptor with a cancellation and stops watching it. */
+    void cancel(int fd);
+
+    /* Schedules a coroutine to be resumed by the loop. Thread-safe. */
+    void post(std::coroutine_handle<> handle);
+
+    /* Runs the loop in the calling thread until stop() is called -- also if it was called before. */
+    void run();
+    void stop();
+
+private:
+    void watch(int fd, Interest interest, Waiter &waiter);
+    void expire(int fd, Interest interest, Waiter &waiter, Clock::time_point deadline);
+    std::coroutine_handle<> release(Waiter &waiter);
+    void update(int fd, Watch &watch);
+    void wake();
+    void resume_posted();
+    void resume_expired();
+    int timeout();
+};
+
+} // namespace SK
+
+#endif // __SK_NETWORK_EVENT_LOOP_H__
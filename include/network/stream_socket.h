@@ -0,0 +1,74 @@
+#ifndef __SK_NETWORK_STREAM_SOCKET_H__
+#define __SK_NETWORK_STREAM_SOCKET_H__
+
+#include <network/socket_options.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace SK {
+
+/*
+    StreamSocket -- a connected (or listening) stream socket of any family.
+    Everything but creating, binding and connecting a socket works the same
+    way over TCP and over Unix domain sockets, so the rooms only ever deal
+    with this class -- TCPSocket and UnixSocket merely set one up.
+*/
+class StreamSocket {
+protected:
+    int socket_fd = -1;
+
+protected:
+    StreamSocket(int socket_fd_)
+    : socket_fd{socket_fd_} {}
+
+    StreamSocket(int domain, int protocol);
+
+public:
+    StreamSocket(StreamSocket&&);
+    StreamSocket &operator=(StreamSocket&&);
+
+    StreamSocket(const StreamSocket&) = delete;
+    StreamSocket &operator=(const StreamSocket&) = delete;
+
+    ~StreamSocket();
+
+    /* Takes over a descriptor of a socket -- one received from another process, say. */
+    static StreamSocket adopt(int socket_fd) {
+        return StreamSocket{socket_fd};
+    }
+
+    int native_handle() const {
+        return socket_fd;
+    }
+
+    void set_socket_blocking(bool value);
+
+    StreamSocket &set_socket_option(const SocketOption &option);
+
+    void listen(int queue_length);
+    std::optional<StreamSocket> accept();
+    // Blocks until the socket is readable (for a listening one -- a connection is pending) or the time is up.
+    bool wait_readable(std::chrono::milliseconds timeout) const;
+    // As above, for whichever of the sockets is the first.
+    static bool wait_readable(std::span<const StreamSocket* const> sockets, std::chrono::milliseconds timeout);
+    // Formatted as "[address]:port" for TCP and as "unix:path" for Unix domain sockets.
+    std::string peer_address() const;
+
+    std::size_t receive(std::span<std::byte> span) const;
+    // Returns std::nullopt if a non-blocking socket has nothing to read yet, 0 if the peer has closed the connection.
+    std::optional<std::size_t> try_receive(std::span<std::byte> span) const;
+    void send(std::span<std::byte> span) const;
+    // Returns how many bytes have been sent -- 0 if a non-blocking socket is not ready.
+    std::size_t send_some(std::span<std::byte> span) const;
+    // As send_some(), for count bytes of the file at the offset -- without copying them into userspace.
+    std::size_t send_file_some(int file_fd, std::uint64_t offset, std::size_t count) const;
+};
+
+} // namespace SK
+
+#endif // __SK_NETWORK_STREAM_SOCKET_H__
@@ -0,0 +1,44 @@
+#ifndef __SK_NETWORK_UNIX_SOCKET_H__
+#define __SK_NETWORK_UNIX_SOCKET_H__
+
+#include <network/stream_socket.h>
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace SK {
+
+/*
+    UnixSocket -- a Unix domain stream socket, for the clients running on
+    the same host as the server, which then do not go through the TCP stack.
+
+    A path starting with '@' names a socket in the abstract namespace:
+    it has no file, and disappears along with the last descriptor of it.
+*/
+class UnixSocket : public StreamSocket {
+public:
+    UnixSocket();
+    // One accepted by a listening UnixSocket.
+    explicit UnixSocket(StreamSocket &&socket);
+
+    // A stale socket file left by a previous server is removed first -- one still accepting connections is not.
+    void bind(const std::string &path);
+    void connect(const std::string &path);
+
+    /*
+        Passes the descriptors to the process at the other end (SCM_RIGHTS),
+        along with the bytes -- which cannot be empty. At most
+        MAX_DESCRIPTORS of them go at once.
+    */
+    void send_descriptors(std::span<const std::byte> bytes, std::span<const int> descriptors) const;
+    // Receives exactly bytes.size() bytes and the sockets sent along with them.
+    std::vector<StreamSocket> receive_descriptors(std::span<std::byte> bytes) const;
+
+    constexpr static std::size_t MAX_DESCRIPTORS = 250;
+};
+
+} // namespace SK
+
+#endif // __SK_NETWORK_UNIX_SOCKET_H__
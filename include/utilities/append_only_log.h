@@ -0,0 +1,168 @@
+#ifndef __SK_UTILITIES_APPEND_ONLY_LOG_H__
+#define __SK_UTILITIES_APPEND_ONLY_LOG_H__
+
+#include <atomic>
+#include <cstddef>      // std::size_t, std::byte
+#include <memory>       // std::destroy_at
+#include <new>          // placement new, std::launder
+#include <stdexcept>    // std::out_of_range
+#include <utility>      // std::forward
+
+namespace SK {
+
+/*
+    AppendOnlyLog -- a single-producer, multi-consumer log of elements.
+
+    The elements are stored in a linked list of fixed-size segments,
+    so once an element has been appended, its address never changes.
+    That lets the consumers read the elements without taking any lock:
+    the producer constructs an element first and only then publishes it
+    by a release-store of the committed length. A consumer acquire-loads
+    the length and may then freely read every element below it.
+
+    Each consumer keeps its own position in the log -- a Cursor.
+    Appending is NOT thread-safe with respect to other producers; only
+    one thread may call push() and emplace() at the same time.
+*/
+template<typename T, std::size_t SegmentSize = 64>
+    requires (SegmentSize > 0)
+class AppendOnlyLog {
+private:
+    struct Segment {
+        alignas(T) std::byte storage[SegmentSize * sizeof(T)];
+        std::atomic<Segment*> next{nullptr};
+
+        T *at(std::size_t index) {
+            return std::launder(reinterpret_cast<T*>(storage) + index);
+        }
+
+        const T *at(std::size_t index) const {
+            return std::launder(reinterpret_cast<const T*>(storage) + index);
+        }
+    };
+
+    // The destructive interference size is not provided by every standard library.
+    constexpr static std::size_t CACHE_LINE_SIZE = 64;
+
+private:
+    Segment *head;
+
+    /* Owned by the producer */
+    Segment *tail;
+    std::size_t tail_index = 0;
+
+    /* Shared with the consumers */
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> committed{0};
+
+public:
+    class Cursor {
+    private:
+        const AppendOnlyLog *log;
+        const Segment *segment;
+        std::size_t position = 0;
+
+    public:
+        Cursor(const AppendOnlyLog &log_)
+        : log{&log_}
+        , segment{log_.head} {}
+
+        /* Returns the next committed element or nullptr if the cursor has caught up with the producer. */
+        const T *next() {
+            if (position >= log->committed.load(std::memory_order_acquire))
+                return nullptr;
+
+            const std::size_t index = position++ % SegmentSize;
+            // The producer links a new segment before committing its first element,
+            // so the acquire-load above makes the link visible as well.
+            if (index == 0 && position > 1)
+                segment = segment->next.load(std::memory_order_relaxed);
+            return segment->at(index);
+        }
+
+        /* The number of elements consumed so far. */
+        std::size_t index() const {
+            return position;
+        }
+
+        /* The number of committed elements not consumed yet. */
+        std::size_t lag() const {
+            return log->size() - position;
+        }
+    };
+
+public:
+    AppendOnlyLog()
+    : head{new Segment{}}
+    , tail{head} {}
+
+    AppendOnlyLog(const AppendOnlyLog&) = delete;
+    AppendOnlyLog &operator=(const AppendOnlyLog&) = delete;
+
+    AppendOnlyLog(AppendOnlyLog&&) = delete;
+    AppendOnlyLog &operator=(AppendOnlyLog&&) = delete;
+
+    ~AppendOnlyLog() {
+        std::size_t remaining = committed.load(std::memory_order_relaxed);
+        Segment *segment = head;
+        while (segment) {
+            const std::size_t count = remaining < SegmentSize ? remaining : SegmentSize;
+            for (std::size_t i = 0; i < count; ++i)
+                std::destroy_at(segment->at(i));
+            remaining -= count;
+
+            Segment *next = segment->next.load(std::memory_order_relaxed);
+            delete segment;
+            segment = next;
+        }
+    }
+
+    template<typename... Args>
+    const T &emplace(Args &&...args) {
+        if (tail_index == SegmentSize) {
+            Segment *segment = new Segment{};
+            tail->next.store(segment, std::memory_order_relaxed);
+            tail = segment;
+            tail_index = 0;
+        }
+
+        T *element = new (tail->storage + tail_index * sizeof(T)) T(std::forward<Args>(args)...);
+        ++tail_index;
+        committed.store(committed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return *element;
+    }
+
+    const T &push(const T &element) {
+        return emplace(element);
+    }
+
+    const T &push(T &&element) {
+        return emplace(std::move(element));
+    }
+
+    std::size_t size() const {
+        return committed.load(std::memory_order_acquire);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /* Random access walks the segments -- prefer a Cursor for sequential reads. */
+    const T &at(std::size_t index) const {
+        if (index >= size())
+            throw std::out_of_range{"[AppendOnlyLog: at] The index exceeds the committed length."};
+
+        const Segment *segment = head;
+        for (std::size_t i = index / SegmentSize; i > 0; --i)
+            segment = segment->next.load(std::memory_order_relaxed);
+        return *segment->at(index % SegmentSize);
+    }
+
+    Cursor cursor() const {
+        return Cursor{*this};
+    }
+};
+
+} // namespace SK
+
+#endif // __SK_UTILITIES_APPEND_ONLY_LOG_H__
@@ -0,0 +1,98 @@
+#ifndef __SK_UTILITIES_HISTOGRAM_H__
+#define __SK_UTILITIES_HISTOGRAM_H__
+
+#include <algorithm>    // std::max
+#include <array>
+#include <atomic>
+#include <bit>          // std::bit_width
+#include <cmath>        // std::ceil
+#include <cstddef>      // std::size_t
+#include <cstdint>
+
+namespace SK {
+
+/*
+    Histogram -- a lock-free histogram of non-negative values with
+    a bounded relative error, in the spirit of HdrHistogram.
+
+    The values below 2^(SubBucketBits + 1) are counted exactly. Above that,
+    every power of two is split into 2^SubBucketBits equal buckets, so that
+    a value is known up to a relative error of 2^-SubBucketBits (about 3%
+    with the default of 5 bits), whatever its magnitude.
+
+    record() is wait-free and may be called from any number of threads.
+    The readers see a consistent value of every single counter, but not
+    necessarily of all of them at once -- which is fine for statistics.
+*/
+template<unsigned SubBucketBits = 5>
+    requires (SubBucketBits > 0 && SubBucketBits < 16)
+class Histogram {
+private:
+    constexpr static std::size_t SUB_BUCKETS = std::size_t{1} << SubBucketBits;
+    constexpr static std::size_t MAX_SHIFT = 64 - (SubBucketBits + 1);
+    constexpr static std::size_t BUCKETS = (MAX_SHIFT + 2) * SUB_BUCKETS;
+
+    std::array<std::atomic<std::uint64_t>, BUCKETS> counts{};
+    std::atomic<std::uint64_t> total{0};
+    std::atomic<std::uint64_t> maximum{0};
+
+    static std::size_t index_of(std::uint64_t value) {
+        const std::size_t width = static_cast<std::size_t>(std::bit_width(value));
+        const std::size_t shift = width > SubBucketBits + 1 ? width - SubBucketBits - 1 : 0;
+        return shift * SUB_BUCKETS + static_cast<std::size_t>(value >> shift);
+    }
+
+    /* The highest value falling into the bucket. */
+    static std::uint64_t value_of(std::size_t index) {
+        if (index < 2 * SUB_BUCKETS)
+            return index;
+        const std::size_t shift = index / SUB_BUCKETS - 1;
+        const std::uint64_t mantissa = index - shift * SUB_BUCKETS;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+public:
+    void record(std::uint64_t value) {
+        counts[index_of(value)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+
+        std::uint64_t current = maximum.load(std::memory_order_relaxed);
+        while (current < value && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed));
+    }
+
+    std::uint64_t count() const {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t max() const {
+        return maximum.load(std::memory_order_relaxed);
+    }
+
+    /* The value below which the given fraction of the recorded values lies, e.g. 0.99 for p99. */
+    std::uint64_t percentile(double fraction) const {
+        const std::uint64_t recorded = count();
+        if (!recorded)
+            return 0;
+
+        const auto rank = std::max<std::uint64_t>(static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(recorded))), 1);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::min(value_of(i), max());
+        }
+        return max();
+    }
+
+    /* Not atomic as a whole -- values recorded in the meantime may partially survive. */
+    void reset() {
+        for (auto &counter : counts)
+            counter.store(0, std::memory_order_relaxed);
+        total.store(0, std::memory_order_relaxed);
+        maximum.store(0, std::memory_order_relaxed);
+    }
+};
+
+} // namespace SK
+
+#endif // __SK_UTILITIES_HISTOGRAM_H__
@@ -0,0 +1,352 @@
+#ifndef __SK_UTILITIES_LOGGER_H__
+#define __SK_UTILITIES_LOGGER_H__
+
+#include <algorithm>    // std::min
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>      // std::size_t
+#include <cstdint>
+#include <cstring>      // std::memcpy
+#include <ctime>        // gmtime_r
+#include <initializer_list>
+#include <iomanip>      // std::setw
+#include <memory>       // std::shared_ptr
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>      // std::move
+#include <vector>
+
+#include <utilities/spsc_ring.h>
+
+/* The least severe level compiled in: 0 -- debug, 1 -- info, 2 -- warning, 3 -- error. */
+#ifndef SK_LOG_LEVEL
+#define SK_LOG_LEVEL 1
+#endif
+
+namespace SK {
+
+enum class LogLevel : std::uint8_t {DEBUG = 0, INFO = 1, WARNING = 2, ERROR = 3};
+
+constexpr LogLevel MIN_LOG_LEVEL = static_cast<LogLevel>(SK_LOG_LEVEL);
+
+constexpr bool log_enabled(LogLevel level) {
+    return level >= MIN_LOG_LEVEL;
+}
+
+/*
+    LogValue -- the value of a field of a log record, stored as is
+    and only turned into text by the flusher.
+
+    String literals are kept by pointer; any other text is copied and
+    cut short to TEXT_SIZE characters, so that a record never owns
+    memory and moving it through a ring costs a memcpy.
+*/
+class LogValue {
+public:
+    constexpr static std::size_t TEXT_SIZE = 30;
+
+private:
+    enum class Kind : std::uint8_t {SIGNED, UNSIGNED, REAL, BOOLEAN, LITERAL, TEXT};
+
+    Kind kind = Kind::SIGNED;
+    std::uint8_t length = 0;
+    union {
+        std::int64_t signed_value = 0;
+        std::uint64_t unsigned_value;
+        double real_value;
+        bool boolean_value;
+        const char *literal;
+        char text[TEXT_SIZE];
+    };
+
+public:
+    LogValue() = default;
+
+    template<std::signed_integral T>
+    LogValue(T value) : kind{Kind::SIGNED}, signed_value{value} {}
+
+    template<std::unsigned_integral T>
+        requires (!std::same_as<T, bool>)
+    LogValue(T value) : kind{Kind::UNSIGNED}, unsigned_value{value} {}
+
+    template<std::same_as<bool> T>
+    LogValue(T value) : kind{Kind::BOOLEAN}, boolean_value{value} {}
+
+    LogValue(double value) : kind{Kind::REAL}, real_value{value} {}
+
+    /* Has to outlive the logger -- which string literals do. */
+    template<std::size_t N>
+    LogValue(const char (&value)[N]) : kind{Kind::LITERAL}, literal{value} {}
+
+    LogValue(std::string_view value) : kind{Kind::TEXT} {
+        length = static_cast<std::uint8_t>(std::min(value.size(), TEXT_SIZE));
+        std::memcpy(text, value.data(), length);
+    }
+
+    LogValue(const std::string &value) : LogValue{std::string_view{value}} {}
+
+    friend std::ostream &operator<<(std::ostream &os, const LogValue &value) {
+        switch (value.kind) {
+            case Kind::SIGNED: return os << value.signed_value;
+            case Kind::UNSIGNED: return os << value.unsigned_value;
+            case Kind::REAL: return os << value.real_value;
+            case Kind::BOOLEAN: return os << (value.boolean_value ? "true" : "false");
+            case Kind::LITERAL: return write_text(os, std::string_view{value.literal});
+            case Kind::TEXT: return write_text(os, std::string_view{value.text, value.length});
+        }
+        return os;
+    }
+
+private:
+    /* Quoted only when it would not read back as a single value otherwise. */
+    static std::ostream &write_text(std::ostream &os, std::string_view text) {
+        if (!text.empty() && text.find_first_of(" =\"\\") == std::string_view::npos)
+            return os << text;
+
+        os << '"';
+        for (const char c : text) {
+            if (c == '"' || c == '\\')
+                os << '\\';
+            os << c;
+        }
+        return os << '"';
+    }
+};
+
+struct LogField {
+    const char *key = "";
+    LogValue value{};
+};
+
+/*
+    Logger -- structured records (an event and a few key=value fields)
+    written to a stream in the logfmt style.
+
+    As with the Tracer, every thread has a ring of its own: logging takes
+    no locks, allocates nothing and never blocks, and a record which does
+    not fit in the full ring is dropped and counted. Formatting the records
+    is left to a background thread, which drains the rings every few
+    milliseconds.
+
+    The levels below SK_LOG_LEVEL are compiled out by the log_* functions.
+    Their arguments are still evaluated, though, so an expensive one should
+    be guarded with log_enabled().
+*/
+class Logger {
+private:
+    constexpr static std::size_t RING_SIZE = 1024;
+    constexpr static std::size_t MAX_FIELDS = 6;
+    constexpr static auto FLUSH_INTERVAL = std::chrono::milliseconds{20};
+
+    struct Record {
+        std::uint64_t timestamp = 0;    // in µs since the epoch
+        const char *event = "";
+        LogLevel level = LogLevel::INFO;
+        std::uint8_t field_count = 0;
+        std::array<LogField, MAX_FIELDS> fields{};
+    };
+
+    struct ThreadBuffer {
+        SpscRing<Record, RING_SIZE> ring{};
+        std::uint32_t id = 0;
+        std::string name{};
+        std::atomic<std::uint64_t> dropped{0};
+        std::uint64_t reported = 0;     // only touched by the flusher
+    };
+
+    std::atomic_bool active = false;
+
+    std::mutex buffers_mutex{};
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers{};
+
+    std::ostream *output = nullptr;
+
+    std::mutex flusher_mutex{};
+    std::condition_variable flusher_wakeup{};
+    bool flusher_stop = false;
+    std::thread flusher{};
+
+    Logger() = default;
+
+public:
+    Logger(const Logger&) = delete;
+    Logger &operator=(const Logger&) = delete;
+
+    ~Logger() {
+        stop();
+    }
+
+    static Logger &instance() {
+        static Logger logger{};
+        return logger;
+    }
+
+    static bool enabled() {
+        return instance().active.load(std::memory_order_relaxed);
+    }
+
+    /* Starts writing the records to the stream, which has to outlive the logger. */
+    void start(std::ostream &os) {
+        if (active)
+            return;
+
+        output = &os;
+        flusher_stop = false;
+        flusher = std::thread{&Logger::flush_routine, this};
+        active = true;
+    }
+
+    /* Stops logging and writes whatever is left. */
+    void stop() {
+        if (!active.exchange(false))
+            return;
+
+        /* lock */ {
+            const std::lock_guard<std::mutex> lock{flusher_mutex};
+            flusher_stop = true;
+        }
+        flusher_wakeup.notify_one();
+        flusher.join();
+        drain();
+    }
+
+    /* Names the calling thread in the records. */
+    void name_thread(std::string name) {
+        ThreadBuffer &buffer = local_buffer();
+        const std::lock_guard<std::mutex> lock{buffers_mutex};
+        buffer.name = std::move(name);
+    }
+
+    void record(LogLevel level, const char *event, std::initializer_list<LogField> fields) {
+        if (!enabled())
+            return;
+
+        Record record{};
+        record.timestamp = now();
+        record.event = event;
+        record.level = level;
+        record.field_count = static_cast<std::uint8_t>(std::min(fields.size(), MAX_FIELDS));
+        std::copy_n(fields.begin(), record.field_count, record.fields.begin());
+
+        ThreadBuffer &buffer = local_buffer();
+        if (!buffer.ring.try_push(std::move(record)))
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    static std::uint64_t now() {
+        const auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(since_epoch).count());
+    }
+
+    static const char *level_name(LogLevel level) {
+        switch (level) {
+            case LogLevel::DEBUG: return "debug";
+            case LogLevel::INFO: return "info";
+            case LogLevel::WARNING: return "warning";
+            case LogLevel::ERROR: return "error";
+        }
+        return "";
+    }
+
+    ThreadBuffer &local_buffer() {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = [this] {
+            auto result = std::make_shared<ThreadBuffer>();
+            const std::lock_guard<std::mutex> lock{buffers_mutex};
+            result->id = static_cast<std::uint32_t>(buffers.size() + 1);
+            buffers.push_back(result);
+            return result;
+        }();
+        return *buffer;
+    }
+
+    void flush_routine() {
+        std::unique_lock<std::mutex> lock{flusher_mutex};
+        while (!flusher_stop) {
+            flusher_wakeup.wait_for(lock, FLUSH_INTERVAL);
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    }
+
+    /* Only ever called by one thread at a time -- the flusher, or stop() once it is gone. */
+    void drain() {
+        std::vector<std::shared_ptr<ThreadBuffer>> snapshot{};
+        /* lock */ {
+            const std::lock_guard<std::mutex> lock{buffers_mutex};
+            snapshot = buffers;
+        }
+
+        Record record{};
+        for (const auto &buffer : snapshot) {
+            std::string name{};
+            /* lock */ {
+                const std::lock_guard<std::mutex> lock{buffers_mutex};
+                name = buffer->name.empty() ? "thread " + std::to_string(buffer->id) : buffer->name;
+            }
+
+            while (buffer->ring.try_pop(record))
+                write_record(name, record);
+
+            const std::uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+            if (dropped != buffer->reported) {
+                Record lost{now(), "log_records_dropped", LogLevel::WARNING, 1, {}};
+                lost.fields[0] = LogField{"count", dropped - buffer->reported};
+                write_record(name, lost);
+                buffer->reported = dropped;
+            }
+        }
+        output->flush();
+    }
+
+    void write_record(const std::string &thread, const Record &record) {
+        const auto seconds = static_cast<std::time_t>(record.timestamp / 1'000'000);
+        std::tm time{};
+        ::gmtime_r(&seconds, &time);
+
+        char date[32];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &time);
+
+        std::ostream &os = *output;
+        os << "time=" << date << '.' << std::setfill('0') << std::setw(6) << record.timestamp % 1'000'000 << 'Z'
+           << " level=" << level_name(record.level)
+           << " thread=" << LogValue{thread}
+           << " event=" << record.event;
+        for (std::size_t i = 0; i < record.field_count; ++i)
+            os << ' ' << record.fields[i].key << '=' << record.fields[i].value;
+        os << '\n';
+    }
+};
+
+template<LogLevel Level>
+inline void log_at(const char *event, std::initializer_list<LogField> fields) {
+    if constexpr (log_enabled(Level))
+        Logger::instance().record(Level, event, fields);
+}
+
+inline void log_debug(const char *event, std::initializer_list<LogField> fields = {}) {
+    log_at<LogLevel::DEBUG>(event, fields);
+}
+
+inline void log_info(const char *event, std::initializer_list<LogField> fields = {}) {
+    log_at<LogLevel::INFO>(event, fields);
+}
+
+inline void log_warning(const char *event, std::initializer_list<LogField> fields = {}) {
+    log_at<LogLevel::WARNING>(event, fields);
+}
+
+inline void log_error(const char *event, std::initializer_list<LogField> fields = {}) {
+    log_at<LogLevel::ERROR>(event, fields);
+}
+
+} // namespace SK
+
+#endif // __SK_UTILITIES_LOGGER_H__
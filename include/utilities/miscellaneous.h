@@ -3,6 +3,10 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>  // std::underlying_type_t
 
 namespace SK {
 
@@ -18,6 +22,21 @@ constexpr auto to_underlying(E e) {
     return static_cast<std::underlying_type_t<E>>(e);
 }
 
+/* The value of a numeric command line option -- anything but a whole number which fits in T is rejected. */
+template<typename T>
+T parse_number(const char *text, char option) {
+    std::size_t end = 0;
+    unsigned long long value = 0;
+    try {
+        value = std::stoull(text, &end);
+    } catch (const std::logic_error&) {
+        end = 0;
+    }
+    if (!end || text[end] || text[0] == '-' || value > std::numeric_limits<T>::max())
+        throw std::invalid_argument{std::string{"[parse_options] Invalid value of -"} + option + "."};
+    return static_cast<T>(value);
+}
+
 } // namespace SK
 
 #endif // __SK_UTILITIES_MISCELLANEOUS_H__
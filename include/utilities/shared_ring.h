@@ -0,0 +1,327 @@
+#ifndef __SK_UTILITIES_SHARED_RING_H__
+#define __SK_UTILITIES_SHARED_RING_H__
+
+#include <fcntl.h>      // O_* constants
+#include <signal.h>     // kill
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>      // std::size_t, std::byte
+#include <cstdint>
+#include <cstring>      // std::memcpy, strerror
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>      // std::exchange
+
+namespace SK {
+
+namespace detail {
+
+/*
+    The layout of a shared ring: the header, followed by the ring of records.
+    Every record starts at a multiple of RECORD_ALIGNMENT with a RecordHeader,
+    and a record which would not fit before the end of the ring is preceded
+    by a padding record filling the rest of it.
+*/
+struct SharedRingHeader {
+    constexpr static std::uint64_t MAGIC = 0x474e495252534b02;   // "SKRRING" and a version
+    constexpr static std::size_t PREAMBLE_SIZE = 1024;
+
+    std::uint64_t magic;
+    std::uint64_t capacity;
+    std::uint64_t writer;   // the process id of the writer
+
+    // Bytes written so far, that is where the next record goes -- only committed records are below it.
+    alignas(64) std::atomic<std::uint64_t> head;
+    // Bytes the writer has started to overwrite -- a reader is lapped once its record is below claim - capacity.
+    std::atomic<std::uint64_t> claim;
+    std::atomic<std::uint64_t> records;
+
+    // What a reader has to be told first, whenever it attaches.
+    alignas(64) std::atomic<std::uint32_t> preamble_length;
+    std::byte preamble[PREAMBLE_SIZE];
+};
+
+struct RecordHeader {
+    std::uint64_t sequence;
+    std::uint32_t length;
+    std::uint32_t padding;  // non-zero for a record only filling the end of the ring
+};
+
+constexpr std::size_t RECORD_ALIGNMENT = sizeof(RecordHeader);
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The readers in other processes rely on lock-free atomics.");
+
+inline std::size_t aligned_record_size(std::size_t length) {
+    return (sizeof(RecordHeader) + length + RECORD_ALIGNMENT - 1) / RECORD_ALIGNMENT * RECORD_ALIGNMENT;
+}
+
+} // namespace detail
+
+/*
+    SharedRing -- a ring of byte records in POSIX shared memory, with a single
+    writer and any number of readers in other processes. The readers take
+    the records straight from the mapping: no syscalls and no copies.
+
+    The writer never waits for the readers. A reader which falls behind by
+    more than the capacity finds out it has been lapped: the writer announces
+    the bytes it is about to overwrite (claim) before touching them, and
+    a reader checks that claim once it has read a record, as with a seqlock.
+
+    The name has to start with '/', as for shm_open(). The memory is unlinked
+    once the writer is gone; the readers keep what they have mapped.
+    A name already taken is refused, unless the writer which has left it
+    behind is no longer running.
+*/
+class SharedRing {
+private:
+    std::string name;
+    detail::SharedRingHeader *header = nullptr;
+    std::byte *ring = nullptr;
+    std::size_t mapped = 0;
+
+    /* Whether the ring of that name has been left behind by a writer which is gone. */
+    static bool stale(const std::string &name) {
+        const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd == -1)
+            return errno == ENOENT;
+
+        struct stat status{};
+        void *memory = MAP_FAILED;
+        if (::fstat(fd, &status) == 0 && static_cast<std::size_t>(status.st_size) >= sizeof(detail::SharedRingHeader))
+            memory = ::mmap(nullptr, sizeof(detail::SharedRingHeader), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        // Not a ring of this version, or one still being set up -- not to be touched either way.
+        if (memory == MAP_FAILED)
+            return false;
+
+        const auto *other = static_cast<const detail::SharedRingHeader*>(memory);
+        const std::uint64_t magic = std::atomic_ref<const std::uint64_t>{other->magic}.load(std::memory_order_acquire);
+        const bool gone = magic == detail::SharedRingHeader::MAGIC
+            && ::kill(static_cast<pid_t>(other->writer), 0) == -1 && errno == ESRCH;
+        ::munmap(memory, sizeof(detail::SharedRingHeader));
+        return gone;
+    }
+
+public:
+    /* The capacity has to be a power of two. */
+    SharedRing(std::string name_, std::size_t capacity)
+    : name{std::move(name_)} {
+        if (capacity < 2 * detail::RECORD_ALIGNMENT || (capacity & (capacity - 1)))
+            throw std::invalid_argument{"[SharedRing: SharedRing] The capacity has to be a power of two."};
+
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd == -1 && errno == EEXIST && stale(name)) {
+            ::shm_unlink(name.c_str());
+            fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        }
+        if (fd == -1 && errno == EEXIST)
+            throw std::runtime_error{"[SharedRing: SharedRing] " + name + " is in use."};
+        if (fd == -1)
+            throw std::runtime_error{"[SharedRing: SharedRing] " + std::string{strerror(errno)}};
+
+        mapped = sizeof(detail::SharedRingHeader) + capacity;
+        void *memory = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(mapped)) == 0)
+            memory = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int error = errno;
+        ::close(fd);
+        if (memory == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error{"[SharedRing: SharedRing] " + std::string{strerror(error)}};
+        }
+
+        // The truncated memory is zeroed, which is a valid state of the atomics.
+        header = static_cast<detail::SharedRingHeader*>(memory);
+        ring = static_cast<std::byte*>(memory) + sizeof(detail::SharedRingHeader);
+        header->capacity = capacity;
+        header->writer = static_cast<std::uint64_t>(::getpid());
+        std::atomic_ref<std::uint64_t>{header->magic}.store(detail::SharedRingHeader::MAGIC, std::memory_order_release);
+    }
+
+    SharedRing(const SharedRing&) = delete;
+    SharedRing &operator=(const SharedRing&) = delete;
+
+    SharedRing(SharedRing &&other)
+    : name{std::move(other.name)}
+    , header{std::exchange(other.header, nullptr)}
+    , ring{std::exchange(other.ring, nullptr)}
+    , mapped{std::exchange(other.mapped, 0)} {}
+
+    SharedRing &operator=(SharedRing&&) = delete;
+
+    ~SharedRing() {
+        if (!header)
+            return;
+        ::munmap(header, mapped);
+        ::shm_unlink(name.c_str());
+    }
+
+    /* Replaced as a whole -- a reader attaching in the meantime may have to read it again. */
+    void set_preamble(std::span<const std::byte> bytes) {
+        if (bytes.size() > detail::SharedRingHeader::PREAMBLE_SIZE)
+            throw std::invalid_argument{"[SharedRing: set_preamble] The preamble is too long."};
+        header->preamble_length.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->preamble, bytes.data(), bytes.size());
+        header->preamble_length.store(static_cast<std::uint32_t>(bytes.size()), std::memory_order_release);
+    }
+
+    /*
+        Returns false, writing nothing, for a record longer than half the ring.
+        Its sequence number is used up all the same: the readers see the gap
+        once the next record comes.
+    */
+    bool write(std::span<const std::byte> bytes) {
+        const std::size_t capacity = header->capacity;
+        const std::size_t size = detail::aligned_record_size(bytes.size());
+        const std::uint64_t sequence = header->records.load(std::memory_order_relaxed);
+        if (size > capacity / 2) {
+            header->records.store(sequence + 1, std::memory_order_release);
+            return false;
+        }
+
+        std::uint64_t position = header->head.load(std::memory_order_relaxed);
+        const std::size_t offset = position & (capacity - 1);
+        const std::size_t left = capacity - offset;
+
+        header->claim.store(position + (left < size ? left : 0) + size, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        if (left < size) {
+            const detail::RecordHeader padding{sequence, static_cast<std::uint32_t>(left - sizeof(detail::RecordHeader)), 1};
+            std::memcpy(ring + offset, &padding, sizeof(padding));
+            position += left;
+        }
+
+        std::byte *record = ring + (position & (capacity - 1));
+        const detail::RecordHeader record_header{sequence, static_cast<std::uint32_t>(bytes.size()), 0};
+        std::memcpy(record, &record_header, sizeof(record_header));
+        std::memcpy(record + sizeof(record_header), bytes.data(), bytes.size());
+
+        header->records.store(sequence + 1, std::memory_order_relaxed);
+        header->head.store(position + size, std::memory_order_release);
+        return true;
+    }
+
+    const std::string &get_name() const {
+        return name;
+    }
+};
+
+/* The reading end of a SharedRing -- each reader keeps its own position. */
+class SharedRingReader {
+public:
+    enum class Status {
+        READ,
+        EMPTY,
+        LAPPED  // the writer has overwritten what has not been read yet -- resync() to go on
+    };
+
+private:
+    const detail::SharedRingHeader *header = nullptr;
+    const std::byte *ring = nullptr;
+    std::size_t mapped = 0;
+    std::uint64_t position = 0;
+    std::uint64_t current = 0;  // where the record returned last starts
+
+public:
+    /* Starts with the records written from now on. */
+    SharedRingReader(const std::string &name) {
+        const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd == -1)
+            throw std::runtime_error{"[SharedRingReader: SharedRingReader] " + std::string{strerror(errno)}};
+
+        struct stat status{};
+        void *memory = MAP_FAILED;
+        if (::fstat(fd, &status) == 0 && static_cast<std::size_t>(status.st_size) > sizeof(detail::SharedRingHeader)) {
+            mapped = static_cast<std::size_t>(status.st_size);
+            memory = ::mmap(nullptr, mapped, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (memory == MAP_FAILED)
+            throw std::runtime_error{"[SharedRingReader: SharedRingReader] The ring cannot be mapped."};
+
+        header = static_cast<const detail::SharedRingHeader*>(memory);
+        ring = static_cast<const std::byte*>(memory) + sizeof(detail::SharedRingHeader);
+        const std::uint64_t magic = std::atomic_ref<const std::uint64_t>{header->magic}.load(std::memory_order_acquire);
+        if (magic != detail::SharedRingHeader::MAGIC || sizeof(detail::SharedRingHeader) + header->capacity != mapped) {
+            ::munmap(memory, mapped);
+            throw std::runtime_error{"[SharedRingReader: SharedRingReader] Not a ring, or a different version of it."};
+        }
+        resync();
+    }
+
+    SharedRingReader(const SharedRingReader&) = delete;
+    SharedRingReader &operator=(const SharedRingReader&) = delete;
+
+    ~SharedRingReader() {
+        ::munmap(const_cast<detail::SharedRingHeader*>(header), mapped);
+    }
+
+    /* Skips to the latest record. */
+    void resync() {
+        position = current = header->head.load(std::memory_order_acquire);
+    }
+
+    /* Copies the preamble out, as it may be replaced at any time. Returns its length. */
+    std::size_t preamble(std::span<std::byte, detail::SharedRingHeader::PREAMBLE_SIZE> out) const {
+        while (true) {
+            const std::uint32_t length = header->preamble_length.load(std::memory_order_acquire);
+            std::memcpy(out.data(), header->preamble, length);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (length && header->preamble_length.load(std::memory_order_relaxed) == length)
+                return length;
+        }
+    }
+
+    /*
+        Points record at the next record in the shared memory and sets sequence
+        to its number -- one more than that of the previous record, unless the
+        writer has dropped some in between. The bytes may be overwritten by
+        the writer anytime: once done with them, check valid().
+    */
+    Status next(std::span<const std::byte> &record, std::uint64_t &sequence) {
+        const std::size_t capacity = header->capacity;
+        while (true) {
+            const std::uint64_t head = header->head.load(std::memory_order_acquire);
+            if (position == head)
+                return Status::EMPTY;
+
+            current = position;
+            detail::RecordHeader record_header{};
+            std::memcpy(&record_header, ring + (position & (capacity - 1)), sizeof(record_header));
+            if (!valid())
+                return Status::LAPPED;
+
+            if (record_header.padding) {
+                position += sizeof(record_header) + record_header.length;
+                continue;
+            }
+
+            sequence = record_header.sequence;
+            record = std::span<const std::byte>{ring + (position & (capacity - 1)) + sizeof(record_header), record_header.length};
+            position += detail::aligned_record_size(record_header.length);
+            return Status::READ;
+        }
+    }
+
+    /* Whether the record returned last is still intact. */
+    bool valid() const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return header->claim.load(std::memory_order_relaxed) <= current + header->capacity;
+    }
+
+    /* The number of records written so far, the dropped ones included. */
+    std::uint64_t records() const {
+        return header->records.load(std::memory_order_acquire);
+    }
+};
+
+} // namespace SK
+
+#endif // __SK_UTILITIES_SHARED_RING_H__
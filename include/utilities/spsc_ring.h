@@ -0,0 +1,76 @@
+#ifndef __SK_UTILITIES_SPSC_RING_H__
+#define __SK_UTILITIES_SPSC_RING_H__
+
+#include <array>
+#include <atomic>
+#include <cstddef>  // std::size_t
+#include <utility>  // std::move
+
+namespace SK {
+
+/*
+    SpscRing -- a bounded, lock-free queue for exactly one producer
+    and exactly one consumer thread.
+
+    Neither side ever waits: try_push() fails if the ring is full
+    and try_pop() fails if it is empty. The producer publishes an
+    element with a release-store of the head, and the consumer frees
+    a slot with a release-store of the tail. Each side only reads the
+    other's index when its cached copy says the ring is full (or empty).
+*/
+template<typename T, std::size_t Capacity>
+    requires (Capacity > 1 && (Capacity & (Capacity - 1)) == 0)
+class SpscRing {
+private:
+    constexpr static std::size_t MASK = Capacity - 1;
+
+    std::array<T, Capacity> slots{};
+
+    alignas(64) std::atomic<std::size_t> head{0};   // written by the producer
+    std::size_t cached_tail = 0;
+
+    alignas(64) std::atomic<std::size_t> tail{0};   // written by the consumer
+    std::size_t cached_head = 0;
+
+public:
+    /* Producer only. */
+    bool try_push(T &&value) {
+        const std::size_t position = head.load(std::memory_order_relaxed);
+        if (position - cached_tail == Capacity) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (position - cached_tail == Capacity)
+                return false;
+        }
+
+        slots[position & MASK] = std::move(value);
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Consumer only. */
+    bool try_pop(T &value) {
+        const std::size_t position = tail.load(std::memory_order_relaxed);
+        if (position == cached_head) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (position == cached_head)
+                return false;
+        }
+
+        value = std::move(slots[position & MASK]);
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* An estimate, exact only when both sides are idle. */
+    std::size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    constexpr static std::size_t capacity() {
+        return Capacity;
+    }
+};
+
+} // namespace SK
+
+#endif // __SK_UTILITIES_SPSC_RING_H__
@@ -0,0 +1,179 @@
+#ifndef __SK_UTILITIES_TASK_H__
+#define __SK_UTILITIES_TASK_H__
+
+#include <coroutine>
+#include <exception>    // std::exception_ptr, std::rethrow_exception
+#include <optional>
+#include <utility>      // std::exchange, std::move
+
+namespace SK {
+
+template<typename T = void>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr exception = nullptr;
+
+    /* When a task finishes, control is handed straight over to whoever awaited it. */
+    struct FinalAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            return handle.promise().continuation;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    void unhandled_exception() noexcept {
+        exception = std::current_exception();
+    }
+
+    void rethrow_if_failed() const {
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+};
+
+template<typename T>
+struct TaskPromise : public TaskPromiseBase {
+    std::optional<T> value = std::nullopt;
+
+    Task<T> get_return_object();
+
+    template<typename U>
+    void return_value(U &&result) {
+        value.emplace(std::forward<U>(result));
+    }
+
+    T take() {
+        rethrow_if_failed();
+        return std::move(value).value();
+    }
+};
+
+template<>
+struct TaskPromise<void> : public TaskPromiseBase {
+    Task<void> get_return_object();
+
+    void return_void() const noexcept {}
+
+    void take() const {
+        rethrow_if_failed();
+    }
+};
+
+} // namespace detail
+
+/*
+    Task -- a lazily started coroutine returning a value of type T.
+    The body of the coroutine does not run until the task is awaited.
+    Afterwards, the awaiting coroutine is resumed as soon as the task
+    finishes, and gets the result (or the exception) out of it.
+*/
+template<typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+public:
+    Task(std::coroutine_handle<promise_type> handle_)
+    : handle{handle_} {}
+
+    Task(Task &&other)
+    : handle{std::exchange(other.handle, nullptr)} {}
+
+    Task &operator=(Task &&other) {
+        if (handle)
+            handle.destroy();
+        handle = std::exchange(other.handle, nullptr);
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task &operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle)
+            handle.destroy();
+    }
+
+    bool await_ready() const noexcept {
+        return !handle || handle.done();
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    T await_resume() {
+        return handle.promise().take();
+    }
+};
+
+namespace detail {
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>{std::coroutine_handle<TaskPromise<T>>::from_promise(*this)};
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>{std::coroutine_handle<TaskPromise<void>>::from_promise(*this)};
+}
+
+/* A fire-and-forget coroutine. Its frame is destroyed as soon as it finishes. */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() const noexcept {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() const noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() const noexcept {
+            return {};
+        }
+
+        void return_void() const noexcept {}
+
+        // There is nobody to report the failure to -- the task is expected
+        // to handle its errors on its own.
+        void unhandled_exception() const noexcept {}
+    };
+};
+
+} // namespace detail
+
+/*
+    Starts a task without waiting for it. Runs it in the current thread
+    until its first suspension point.
+*/
+template<typename T>
+detail::Detached spawn(Task<T> task) {
+    co_await std::move(task);
+}
+
+} // namespace SK
+
+#endif // __SK_UTILITIES_TASK_H__
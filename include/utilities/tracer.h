@@ -0,0 +1,237 @@
+#ifndef __SK_UTILITIES_TRACER_H__
+#define __SK_UTILITIES_TRACER_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>       // std::shared_ptr
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>      // std::move
+#include <vector>
+
+#include <utilities/spsc_ring.h>
+
+namespace SK {
+
+/* A single trace event -- the names are expected to be string literals. */
+struct TraceEvent {
+    const char *name = "";
+    const char *category = "";
+    char phase = 'X';
+    std::uint64_t timestamp = 0;    // in µs
+    std::uint64_t duration = 0;     // in µs, only for complete events
+};
+
+/*
+    Tracer -- writes what the threads are doing in the Chrome trace-event
+    format, which can be opened in Perfetto or chrome://tracing.
+
+    Every thread records its events into a ring buffer of its own, so
+    recording takes no locks and never blocks: when the ring is full,
+    the event is dropped and counted. A background thread drains the
+    rings into the file every few milliseconds.
+
+    While tracing is off, a TraceSpan costs a single relaxed load.
+*/
+class Tracer {
+private:
+    constexpr static std::size_t RING_SIZE = 8192;
+    constexpr static auto FLUSH_INTERVAL = std::chrono::milliseconds{20};
+
+    struct ThreadBuffer {
+        SpscRing<TraceEvent, RING_SIZE> ring{};
+        std::uint32_t id = 0;
+        std::string name{};
+        std::atomic<std::uint64_t> dropped{0};
+    };
+
+    std::atomic_bool active = false;
+
+    std::mutex buffers_mutex{};
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers{};
+
+    std::ofstream output{};
+    bool first_event = true;
+
+    std::mutex flusher_mutex{};
+    std::condition_variable flusher_wakeup{};
+    bool flusher_stop = false;
+    std::thread flusher{};
+
+    Tracer() = default;
+
+public:
+    Tracer(const Tracer&) = delete;
+    Tracer &operator=(const Tracer&) = delete;
+
+    ~Tracer() {
+        stop();
+    }
+
+    static Tracer &instance() {
+        static Tracer tracer{};
+        return tracer;
+    }
+
+    static bool enabled() {
+        return instance().active.load(std::memory_order_relaxed);
+    }
+
+    static std::uint64_t now() {
+        const auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(since_epoch).count());
+    }
+
+    /* Starts writing the trace to the file. */
+    void start(const std::string &path) {
+        if (active)
+            return;
+
+        output.open(path, std::ios::out | std::ios::trunc);
+        if (!output)
+            throw std::runtime_error{"[Tracer: start] Cannot open " + path + "."};
+        output << "[\n";
+        first_event = true;
+
+        flusher_stop = false;
+        flusher = std::thread{&Tracer::flush_routine, this};
+        active = true;
+    }
+
+    /* Stops tracing and writes whatever is left. */
+    void stop() {
+        if (!active.exchange(false))
+            return;
+
+        /* lock */ {
+            const std::lock_guard<std::mutex> lock{flusher_mutex};
+            flusher_stop = true;
+        }
+        flusher_wakeup.notify_one();
+        flusher.join();
+
+        drain();
+        const std::lock_guard<std::mutex> lock{buffers_mutex};
+        for (const auto &buffer : buffers) {
+            if (!buffer->name.empty())
+                write_metadata(*buffer);
+        }
+        output << "\n]\n";
+        output.close();
+    }
+
+    /* Names the calling thread in the trace. */
+    void name_thread(std::string name) {
+        ThreadBuffer &buffer = local_buffer();
+        const std::lock_guard<std::mutex> lock{buffers_mutex};
+        buffer.name = std::move(name);
+    }
+
+    void record(TraceEvent &&event) {
+        ThreadBuffer &buffer = local_buffer();
+        if (!buffer.ring.try_push(std::move(event)))
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    ThreadBuffer &local_buffer() {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = [this] {
+            auto result = std::make_shared<ThreadBuffer>();
+            const std::lock_guard<std::mutex> lock{buffers_mutex};
+            result->id = static_cast<std::uint32_t>(buffers.size() + 1);
+            buffers.push_back(result);
+            return result;
+        }();
+        return *buffer;
+    }
+
+    void flush_routine() {
+        std::unique_lock<std::mutex> lock{flusher_mutex};
+        while (!flusher_stop) {
+            flusher_wakeup.wait_for(lock, FLUSH_INTERVAL);
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    }
+
+    /* Only ever called by one thread at a time -- the flusher, or stop() once it is gone. */
+    void drain() {
+        std::vector<std::shared_ptr<ThreadBuffer>> snapshot{};
+        /* lock */ {
+            const std::lock_guard<std::mutex> lock{buffers_mutex};
+            snapshot = buffers;
+        }
+
+        TraceEvent event{};
+        for (const auto &buffer : snapshot) {
+            while (buffer->ring.try_pop(event))
+                write_event(buffer->id, event);
+        }
+        output.flush();
+    }
+
+    void separate() {
+        if (!first_event)
+            output << ",\n";
+        first_event = false;
+    }
+
+    void write_event(std::uint32_t thread, const TraceEvent &event) {
+        separate();
+        output << R"({"name":")" << event.name
+               << R"(","cat":")" << event.category
+               << R"(","ph":")" << event.phase
+               << R"(","ts":)" << event.timestamp
+               << R"(,"pid":1,"tid":)" << thread;
+        if (event.phase == 'X')
+            output << R"(,"dur":)" << event.duration;
+        else if (event.phase == 'i')
+            output << R"(,"s":"t")";
+        output << '}';
+    }
+
+    void write_metadata(const ThreadBuffer &buffer) {
+        separate();
+        output << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buffer.id
+               << R"(,"args":{"name":")" << buffer.name
+               << R"(","dropped_events":)" << buffer.dropped.load(std::memory_order_relaxed) << "}}";
+    }
+};
+
+/* Records the time between its construction and destruction as a complete event. */
+class TraceSpan {
+private:
+    const char *name;
+    const char *category;
+    const std::uint64_t start;
+
+public:
+    TraceSpan(const char *name_, const char *category_ = "")
+    : name{name_}
+    , category{category_}
+    , start{Tracer::enabled() ? Tracer::now() : 0} {}
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan &operator=(const TraceSpan&) = delete;
+
+    ~TraceSpan() {
+        if (start && Tracer::enabled())
+            Tracer::instance().record(TraceEvent{name, category, 'X', start, Tracer::now() - start});
+    }
+};
+
+/* Records a point in time. */
+inline void trace_instant(const char *name, const char *category = "") {
+    if (Tracer::enabled())
+        Tracer::instance().record(TraceEvent{name, category, 'i', Tracer::now(), 0});
+}
+
+} // namespace SK
+
+#endif // __SK_UTILITIES_TRACER_H__
@@ -0,0 +1,82 @@
+#ifndef __SK_AUXILIARY_H__
+#define __SK_AUXILIARY_H__
+
+#include <messages/client_messages.h>
+
+#include <cstddef>
+#include <functional>   // std::reference_wrapper
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace SK {
+
+/* Inserter writing serialised bytes into a fixed-size buffer. */
+struct SimpleInserter {
+    using value_type = std::byte;
+
+    std::span<std::byte> span;
+    std::size_t index = 0;
+
+    void push(std::byte byte) {
+        if (index >= span.size())
+            throw std::out_of_range{"[SimpleInserter: push] The buffer is too small for the message."};
+        span[index++] = byte;
+    }
+};
+
+/* Consumer reading bytes to deserialise out of a buffer. */
+struct SimpleConsumer {
+    std::span<const std::byte> span;
+    std::size_t index = 0;
+
+    std::byte get() const {
+        if (index >= span.size())
+            throw std::out_of_range{"[SimpleConsumer: get] The message is incomplete."};
+        return span[index];
+    }
+
+    void pop() {
+        ++index;
+    }
+};
+
+/* Inserter appending serialised bytes to a vector -- for messages of unbounded size. */
+class VectorInserter {
+private:
+    std::reference_wrapper<std::vector<std::byte>> bytes;
+
+public:
+    using value_type = std::byte;
+
+    VectorInserter(std::vector<std::byte> &bytes_)
+    : bytes{std::ref(bytes_)} {}
+
+    void push(std::byte byte) {
+        bytes.get().push_back(byte);
+    }
+};
+
+inline bool is_complete_message(std::span<std::byte> span) {
+    if (!span.size_bytes())
+        return false;
+
+    auto it = span.begin();
+    switch (*it) {
+        case Join::ID:
+            if (span.size_bytes() > 1)
+                return span.size_bytes() >= std::to_integer<std::size_t>(*++it) + 2;
+            return false;
+        case PlaceBlock::ID:
+        case PlaceBomb::ID:
+            return true;
+        case Move::ID:
+            return span.size_bytes() > 1;
+        default:
+            throw std::runtime_error{"TODO"}; // TODO
+    }
+}
+
+} // namespace SK
+
+#endif // __SK_AUXILIARY_H__
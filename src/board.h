@@ -0,0 +1,382 @@
+#ifndef __SK_BOARD_H__
+#define __SK_BOARD_H__
+
+#include <messages/common.h>
+
+#include <algorithm>    // std::fill, std::min, std::max
+#include <array>
+#include <bit>          // std::popcount, std::countr_zero, std::countl_zero
+#include <cstddef>      // std::size_t
+#include <optional>
+#include <vector>
+
+namespace SK {
+
+struct Cell {
+    u16 x;
+    u16 y;
+
+    bool operator==(const Cell&) const = default;
+};
+
+/*
+    BitMatrix -- a matrix of bits stored line by line. Every line starts
+    at the beginning of a word, so a line never shares a word with another
+    one -- that makes scanning a line a matter of a few word operations.
+
+    A matrix larger than DENSE_LIMIT words is tiled instead: it is cut into
+    tiles of 64 lines of a single word each, and only the tiles holding
+    a set bit are allocated. A word of a line is then the line of a tile,
+    so the scans stay the same -- except that they skip the missing tiles
+    a word of a bitmap at a time, 64 tiles at once. A board of 65535x65535
+    cells takes a few megabytes rather than half a gigabyte, as long as
+    there are few blocks on it.
+*/
+class BitMatrix {
+public:
+    using Word = u64;
+
+    constexpr static std::size_t WORD_BITS = 64;
+    // 8 MiB -- a board of 8192x8192 cells is still dense.
+    constexpr static std::size_t DENSE_LIMIT = std::size_t{1} << 20;
+
+private:
+    constexpr static std::size_t TILE_LINES = WORD_BITS;
+    constexpr static u32 NO_TILE = 0;
+
+    struct Tile {
+        std::array<Word, TILE_LINES> lines{};
+        std::size_t bits = 0;
+    };
+
+    std::size_t line_count = 0;
+    std::size_t stride = 0; // words per line
+    bool tiled = false;
+
+    /* Dense */
+    std::vector<Word> words{};
+
+    /* Tiled -- directory[line / TILE_LINES * stride + w] is one past the index of the tile, NO_TILE if there is none */
+    std::vector<u32> directory{};
+    std::vector<Tile> tiles{};
+    std::vector<u32> free_tiles{};
+    std::size_t present_stride = 0;
+    std::vector<Word> present{};    // a bit for every entry of the directory
+
+public:
+    BitMatrix() = default;
+
+    /* A dense_limit of 0 tiles any matrix -- which is how the tiled mode is checked against the dense one. */
+    BitMatrix(std::size_t lines, std::size_t line_length, std::size_t dense_limit = DENSE_LIMIT)
+    : line_count{lines}
+    , stride{(line_length + WORD_BITS - 1) / WORD_BITS}
+    , tiled{stride * lines > dense_limit} {
+        if (!tiled) {
+            words.assign(stride * lines, 0);
+            return;
+        }
+        const std::size_t tile_lines = (lines + TILE_LINES - 1) / TILE_LINES;
+        directory.assign(tile_lines * stride, NO_TILE);
+        present_stride = (stride + WORD_BITS - 1) / WORD_BITS;
+        present.assign(tile_lines * present_stride, 0);
+    }
+
+    bool is_tiled() const {
+        return tiled;
+    }
+
+    /* The tiles allocated, 0 for a dense matrix. */
+    std::size_t tile_count() const {
+        return tiles.size() - free_tiles.size();
+    }
+
+    bool test(std::size_t line, std::size_t i) const {
+        return word_at(line, i / WORD_BITS) & bit(i);
+    }
+
+    void set(std::size_t line, std::size_t i) {
+        if (!tiled) {
+            words[line * stride + i / WORD_BITS] |= bit(i);
+            return;
+        }
+        Tile &tile = tile_for(line, i / WORD_BITS);
+        Word &word = tile.lines[line % TILE_LINES];
+        if (!(word & bit(i))) {
+            word |= bit(i);
+            ++tile.bits;
+        }
+    }
+
+    void reset(std::size_t line, std::size_t i) {
+        if (!tiled) {
+            words[line * stride + i / WORD_BITS] &= ~bit(i);
+            return;
+        }
+        const std::size_t entry = line / TILE_LINES * stride + i / WORD_BITS;
+        if (directory[entry] == NO_TILE)
+            return;
+        Tile &tile = tiles[directory[entry] - 1];
+        Word &word = tile.lines[line % TILE_LINES];
+        if (word & bit(i)) {
+            word &= ~bit(i);
+            if (!--tile.bits)
+                release(entry);
+        }
+    }
+
+    void clear() {
+        if (!tiled) {
+            std::fill(words.begin(), words.end(), Word{0});
+            return;
+        }
+        std::fill(directory.begin(), directory.end(), NO_TILE);
+        std::fill(present.begin(), present.end(), Word{0});
+        tiles.clear();
+        free_tiles.clear();
+    }
+
+    std::size_t popcount() const {
+        std::size_t result = 0;
+        for (const Word word : words)
+            result += static_cast<std::size_t>(std::popcount(word));
+        for (const Tile &tile : tiles)
+            for (const Word word : tile.lines)
+                result += static_cast<std::size_t>(std::popcount(word));
+        return result;
+    }
+
+    /* The lowest set bit in [from, to] of the line. */
+    std::optional<std::size_t> find_first(std::size_t line, std::size_t from, std::size_t to) const {
+        const std::size_t first_word = from / WORD_BITS;
+        const std::size_t last_word = to / WORD_BITS;
+        for (std::size_t w = skip_forward(line, first_word, last_word); w <= last_word; w = skip_forward(line, w + 1, last_word)) {
+            Word word = word_at(line, w);
+            if (w == first_word)
+                word &= ~Word{0} << (from % WORD_BITS);
+            if (w == last_word)
+                word &= ~Word{0} >> (WORD_BITS - 1 - to % WORD_BITS);
+            if (word)
+                return w * WORD_BITS + static_cast<std::size_t>(std::countr_zero(word));
+        }
+        return std::nullopt;
+    }
+
+    /* The highest set bit in [from, to] of the line. */
+    std::optional<std::size_t> find_last(std::size_t line, std::size_t from, std::size_t to) const {
+        const std::size_t first_word = from / WORD_BITS;
+        const std::size_t last_word = to / WORD_BITS;
+        for (std::size_t end = skip_backward(line, last_word + 1, first_word); end > first_word; end = skip_backward(line, end - 1, first_word)) {
+            const std::size_t w = end - 1;
+            Word word = word_at(line, w);
+            if (w == first_word)
+                word &= ~Word{0} << (from % WORD_BITS);
+            if (w == last_word)
+                word &= ~Word{0} >> (WORD_BITS - 1 - to % WORD_BITS);
+            if (word)
+                return w * WORD_BITS + WORD_BITS - 1 - static_cast<std::size_t>(std::countl_zero(word));
+        }
+        return std::nullopt;
+    }
+
+    /* Calls f(i) for every set bit in [from, to] of the line, in increasing order. */
+    template<typename F>
+    void for_each_in(std::size_t line, std::size_t from, std::size_t to, F &&f) const {
+        const std::size_t first_word = from / WORD_BITS;
+        const std::size_t last_word = to / WORD_BITS;
+        for (std::size_t w = skip_forward(line, first_word, last_word); w <= last_word; w = skip_forward(line, w + 1, last_word)) {
+            Word word = word_at(line, w);
+            if (w == first_word)
+                word &= ~Word{0} << (from % WORD_BITS);
+            if (w == last_word)
+                word &= ~Word{0} >> (WORD_BITS - 1 - to % WORD_BITS);
+            while (word) {
+                f(w * WORD_BITS + static_cast<std::size_t>(std::countr_zero(word)));
+                word &= word - 1;
+            }
+        }
+    }
+
+    /* Calls f(line, i) for every set bit, line by line. */
+    template<typename F>
+    void for_each(F &&f) const {
+        if (!stride)
+            return;
+        for (std::size_t line = 0; line < line_count; ++line) {
+            // A whole band of missing tiles is skipped at once.
+            if (tiled && line % TILE_LINES == 0 && skip_forward(line, 0, stride - 1) == stride) {
+                line += TILE_LINES - 1;
+                continue;
+            }
+            for_each_in(line, 0, stride * WORD_BITS - 1, [&](std::size_t i) {
+                f(line, i);
+            });
+        }
+    }
+
+private:
+    static Word bit(std::size_t i) {
+        return Word{1} << (i % WORD_BITS);
+    }
+
+    Word word_at(std::size_t line, std::size_t w) const {
+        if (!tiled)
+            return words[line * stride + w];
+        const u32 index = directory[line / TILE_LINES * stride + w];
+        return index == NO_TILE ? Word{0} : tiles[index - 1].lines[line % TILE_LINES];
+    }
+
+    /* The first word in [w, last] of the line which might have a bit set, last + 1 if there is none. */
+    std::size_t skip_forward(std::size_t line, std::size_t w, std::size_t last) const {
+        if (!tiled || w > last)
+            return w;
+        const Word *base = present.data() + line / TILE_LINES * present_stride;
+        for (std::size_t p = w / WORD_BITS; p <= last / WORD_BITS; ++p) {
+            Word mask = base[p];
+            if (p == w / WORD_BITS)
+                mask &= ~Word{0} << (w % WORD_BITS);
+            if (mask)
+                return std::min(p * WORD_BITS + static_cast<std::size_t>(std::countr_zero(mask)), last + 1);
+        }
+        return last + 1;
+    }
+
+    /* One past the last word in [first, end) of the line which might have a bit set, first if there is none. */
+    std::size_t skip_backward(std::size_t line, std::size_t end, std::size_t first) const {
+        if (!tiled || end <= first)
+            return end;
+        const Word *base = present.data() + line / TILE_LINES * present_stride;
+        for (std::size_t p = (end - 1) / WORD_BITS + 1; p-- > first / WORD_BITS;) {
+            Word mask = base[p];
+            if (p == (end - 1) / WORD_BITS)
+                mask &= ~Word{0} >> (WORD_BITS - 1 - (end - 1) % WORD_BITS);
+            if (mask)
+                return std::max(p * WORD_BITS + WORD_BITS - static_cast<std::size_t>(std::countl_zero(mask)), first);
+        }
+        return first;
+    }
+
+    Tile &tile_for(std::size_t line, std::size_t w) {
+        const std::size_t entry = line / TILE_LINES * stride + w;
+        if (directory[entry] == NO_TILE) {
+            if (free_tiles.empty()) {
+                tiles.emplace_back();
+                directory[entry] = static_cast<u32>(tiles.size());
+            } else {
+                directory[entry] = free_tiles.back();
+                free_tiles.pop_back();
+            }
+            present[entry / stride * present_stride + w / WORD_BITS] |= bit(w);
+        }
+        return tiles[directory[entry] - 1];
+    }
+
+    /* The tile is empty -- it goes back to the pool. */
+    void release(std::size_t entry) {
+        const std::size_t w = entry % stride;
+        present[entry / stride * present_stride + w / WORD_BITS] &= ~bit(w);
+        free_tiles.push_back(directory[entry]);
+        directory[entry] = NO_TILE;
+    }
+};
+
+/*
+    BlockBoard -- the set of blocked cells, one bit per cell.
+
+    The cells are stored row by row, and mirrored column by column,
+    so that both horizontal and vertical rays can be cast with word scans.
+*/
+class BlockBoard {
+private:
+    u16 size_x = 0;
+    u16 size_y = 0;
+    std::size_t block_count = 0;
+    BitMatrix rows{};
+    BitMatrix columns{};
+
+public:
+    BlockBoard() = default;
+
+    BlockBoard(u16 size_x_, u16 size_y_)
+    : size_x{size_x_}
+    , size_y{size_y_}
+    , rows{size_y_, size_x_}
+    , columns{size_x_, size_y_} {}
+
+    u16 width() const {
+        return size_x;
+    }
+
+    u16 height() const {
+        return size_y;
+    }
+
+    bool has_block(u16 x, u16 y) const {
+        return rows.test(y, x);
+    }
+
+    /* Returns false if the cell was already blocked. */
+    bool place(u16 x, u16 y) {
+        if (rows.test(y, x))
+            return false;
+        rows.set(y, x);
+        columns.set(x, y);
+        ++block_count;
+        return true;
+    }
+
+    /* Returns false if there was no block on the cell. */
+    bool destroy(u16 x, u16 y) {
+        if (!rows.test(y, x))
+            return false;
+        rows.reset(y, x);
+        columns.reset(x, y);
+        --block_count;
+        return true;
+    }
+
+    std::size_t count() const {
+        return block_count;
+    }
+
+    /* Recounts the blocks from scratch -- useful for verifying the cached counter. */
+    std::size_t popcount() const {
+        return rows.popcount();
+    }
+
+    void clear() {
+        rows.clear();
+        columns.clear();
+        block_count = 0;
+    }
+
+    /*
+        The nearest block in row y between the columns from_x and to_x (inclusive),
+        looking from from_x towards to_x. The same goes for columns.
+    */
+    std::optional<u16> nearest_in_row(u16 y, u16 from_x, u16 to_x) const {
+        return narrow(from_x <= to_x ? rows.find_first(y, from_x, to_x) : rows.find_last(y, to_x, from_x));
+    }
+
+    std::optional<u16> nearest_in_column(u16 x, u16 from_y, u16 to_y) const {
+        return narrow(from_y <= to_y ? columns.find_first(x, from_y, to_y) : columns.find_last(x, to_y, from_y));
+    }
+
+    /* Calls f(x, y) for every block, row by row. */
+    template<typename F>
+    void for_each(F &&f) const {
+        rows.for_each([&](std::size_t y, std::size_t x) {
+            f(static_cast<u16>(x), static_cast<u16>(y));
+        });
+    }
+
+private:
+    static std::optional<u16> narrow(std::optional<std::size_t> value) {
+        if (value)
+            return static_cast<u16>(*value);
+        return std::nullopt;
+    }
+};
+
+} // namespace SK
+
+#endif // __SK_BOARD_H__
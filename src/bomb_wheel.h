@@ -0,0 +1,86 @@
+#ifndef __SK_BOMB_WHEEL_H__
+#define __SK_BOMB_WHEEL_H__
+
+#include <messages/common.h>
+
+#include <cstddef>  // std::size_t
+#include <vector>
+
+#include "board.h"
+
+namespace SK {
+
+/*
+    BombWheel -- the live bombs bucketed by the turn they explode in.
+
+    Every bomb has the same timer, so a wheel with bomb_timer + 1 buckets
+    is enough for no two turns to share a bucket. Bombs land in a bucket
+    in the order they are armed, i.e. by increasing IDs -- which is
+    the order the explosions have to be reported in.
+*/
+class BombWheel {
+public:
+    struct Bomb {
+        BombId id;
+        Cell position;
+        u32 expiry; // the turn the bomb explodes in
+
+        bool operator==(const Bomb&) const = default;
+    };
+
+private:
+    u32 bomb_timer;
+    std::size_t live = 0;
+    std::vector<std::vector<Bomb>> buckets;
+
+public:
+    BombWheel(u16 bomb_timer_)
+    // A bomb with no timer would explode before it has been placed -- it waits one turn instead.
+    : bomb_timer{bomb_timer_ ? bomb_timer_ : u32{1}}
+    , buckets(bomb_timer + 1) {}
+
+    /* Arms a bomb placed during the given turn. */
+    void arm(BombId id, Cell position, u32 turn) {
+        const u32 expiry = turn + bomb_timer;
+        buckets[expiry % buckets.size()].push_back(Bomb{id, position, expiry});
+        ++live;
+    }
+
+    /*
+        Moves the bombs exploding in the given turn into out, replacing its content.
+        The buffers are swapped, so no allocation happens once the capacities settle.
+    */
+    void take(u32 turn, std::vector<Bomb> &out) {
+        auto &bucket = buckets[turn % buckets.size()];
+        out.clear();
+        out.swap(bucket);
+        live -= out.size();
+    }
+
+    std::size_t size() const {
+        return live;
+    }
+
+    /* The number of turns the bomb has left, as of the given turn. */
+    static u16 timer(const Bomb &bomb, u32 turn) {
+        return static_cast<u16>(bomb.expiry - turn);
+    }
+
+    /* Calls f(bomb) for every live bomb, in no particular order. */
+    template<typename F>
+    void for_each(F &&f) const {
+        for (const auto &bucket : buckets)
+            for (const Bomb &bomb : bucket)
+                f(bomb);
+    }
+
+    void clear() {
+        for (auto &bucket : buckets)
+            bucket.clear();
+        live = 0;
+    }
+};
+
+} // namespace SK
+
+#endif // __SK_BOMB_WHEEL_H__
@@ -0,0 +1,72 @@
+#ifndef __SK_CONNECTION_STATS_H__
+#define __SK_CONNECTION_STATS_H__
+
+#include <network/async_socket.h>
+#include <utilities/histogram.h>
+#include <utilities/logger.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace SK {
+
+/*
+    ConnectionStats -- the traffic of the clients, shared by all the rooms.
+    The counters of a connection are added up once it is closed; the lag
+    (how many messages a client is behind the head of the feed) is sampled
+    every time it gets a message.
+*/
+struct ConnectionStats {
+    Histogram<> lag{};
+
+    std::atomic<std::uint64_t> closed{0};
+    std::atomic<std::uint64_t> slow{0};     // clients which have fallen behind more than allowed
+    std::atomic<std::uint64_t> evicted{0};
+
+    std::atomic<std::uint64_t> bytes_in{0};
+    std::atomic<std::uint64_t> bytes_out{0};
+    std::atomic<std::uint64_t> receives{0};
+    std::atomic<std::uint64_t> sends{0};
+    std::atomic<std::uint64_t> short_writes{0};
+    std::atomic<std::uint64_t> would_block{0};
+
+    void add(const AsyncSocket::Counters &counters) {
+        closed.fetch_add(1, std::memory_order_relaxed);
+        bytes_in.fetch_add(counters.bytes_in, std::memory_order_relaxed);
+        bytes_out.fetch_add(counters.bytes_out, std::memory_order_relaxed);
+        receives.fetch_add(counters.receives, std::memory_order_relaxed);
+        sends.fetch_add(counters.sends, std::memory_order_relaxed);
+        short_writes.fetch_add(counters.short_writes, std::memory_order_relaxed);
+        would_block.fetch_add(counters.would_block, std::memory_order_relaxed);
+    }
+
+    void log() const {
+        const auto load = [](const std::atomic<std::uint64_t> &counter) {
+            return counter.load(std::memory_order_relaxed);
+        };
+
+        log_info("connections", {
+            {"closed", load(closed)},
+            {"slow", load(slow)},
+            {"evicted", load(evicted)}
+        });
+        log_info("traffic", {
+            {"bytes_in", load(bytes_in)},
+            {"receives", load(receives)},
+            {"bytes_out", load(bytes_out)},
+            {"sends", load(sends)},
+            {"short_writes", load(short_writes)},
+            {"would_block", load(would_block)}
+        });
+        log_info("lag", {
+            {"p50", lag.percentile(0.5)},
+            {"p99", lag.percentile(0.99)},
+            {"p999", lag.percentile(0.999)},
+            {"max", lag.max()}
+        });
+    }
+};
+
+} // namespace SK
+
+#endif // __SK_CONNECTION_STATS_H__
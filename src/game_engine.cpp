@@ -0,0 +1,291 @@
+#include "game_engine.h"
+
+#include <algorithm>    // std::min, std::copy, std::fill, std::sort
+#include <utility>      // std::as_const
+
+namespace SK {
+
+namespace {
+
+Position to_position(Cell cell) {
+    Position position{};
+    position.get<"x">() = cell.x;
+    position.get<"y">() = cell.y;
+    return position;
+}
+
+Event::Event player_moved(PlayerId id, Cell cell) {
+    Event::PlayerMoved event{};
+    event.get<"id">() = id;
+    event.get<"position">() = to_position(cell);
+    return event;
+}
+
+Turn make_turn(u16 number, std::vector<Event::Event> &&events) {
+    Turn result{};
+    result.get<"turn">() = number;
+    result.get<"events">() = List<Event::Event>(std::move(events));
+    return result;
+}
+
+} // anonymous namespace
+
+template<std::size_t MaxPlayers>
+BasicGameEngine<MaxPlayers>::BasicGameEngine(const ServerParameters &parameters_, Random &random_)
+: parameters{parameters_}
+, random{random_}
+, players{parameters_.players_count}
+, bombs{parameters_.bomb_timer}
+, blocks{parameters_.size_x, parameters_.size_y}
+, occupancy{parameters_.size_x, parameters_.size_y} {}
+
+template<std::size_t MaxPlayers>
+Cell BasicGameEngine<MaxPlayers>::random_cell() {
+    // The order of the calls matters -- x is drawn first.
+    const u16 x = static_cast<u16>(random() % parameters.size_x);
+    const u16 y = static_cast<u16>(random() % parameters.size_y);
+    return Cell{x, y};
+}
+
+template<std::size_t MaxPlayers>
+void BasicGameEngine<MaxPlayers>::place_robot(PlayerId id, Cell cell) {
+    occupancy.move(id, players.position(id), cell);
+    players.set_position(id, cell);
+}
+
+template<std::size_t MaxPlayers>
+Turn BasicGameEngine<MaxPlayers>::start() {
+    std::vector<Event::Event> events{};
+
+    for (std::size_t id = 0; id < players.size(); ++id) {
+        const Cell cell = random_cell();
+        players.set_position(id, cell);
+        players.alive()[id] = 1;
+        occupancy.add(static_cast<PlayerId>(id), cell);
+        events.push_back(player_moved(static_cast<PlayerId>(id), cell));
+    }
+
+    for (u16 i = 0; i < parameters.initial_blocks; ++i) {
+        const Cell cell = random_cell();
+        if (blocks.place(cell.x, cell.y)) {
+            Event::BlockPlaced event{};
+            event.get<"position">() = to_position(cell);
+            events.push_back(std::move(event));
+        }
+    }
+
+    return make_turn(turn, std::move(events));
+}
+
+/*
+    An arm of the cross ends at the nearest block in its range, which is
+    found with a scan over the words of the row (or the column) rather
+    than by walking cell by cell -- so the cost hardly depends on the radius.
+*/
+template<std::size_t MaxPlayers>
+auto BasicGameEngine<MaxPlayers>::explosion_range(Cell bomb) const -> Cross {
+    Cross cross{bomb, bomb.x, bomb.x, bomb.y, bomb.y};
+
+    // A block on the cell of the bomb absorbs the whole explosion.
+    if (blocks.has_block(bomb.x, bomb.y) || !parameters.explosion_radius)
+        return cross;
+
+    const u16 radius = parameters.explosion_radius;
+
+    if (bomb.x + 1 < parameters.size_x) {
+        const u16 limit = static_cast<u16>(std::min<u32>(u32{bomb.x} + radius, parameters.size_x - 1u));
+        cross.right = blocks.nearest_in_row(bomb.y, static_cast<u16>(bomb.x + 1), limit).value_or(limit);
+    }
+    if (bomb.x > 0) {
+        const u16 limit = static_cast<u16>(bomb.x - std::min(radius, bomb.x));
+        cross.left = blocks.nearest_in_row(bomb.y, static_cast<u16>(bomb.x - 1), limit).value_or(limit);
+    }
+    if (bomb.y + 1 < parameters.size_y) {
+        const u16 limit = static_cast<u16>(std::min<u32>(u32{bomb.y} + radius, parameters.size_y - 1u));
+        cross.up = blocks.nearest_in_column(bomb.x, static_cast<u16>(bomb.y + 1), limit).value_or(limit);
+    }
+    if (bomb.y > 0) {
+        const u16 limit = static_cast<u16>(bomb.y - std::min(radius, bomb.y));
+        cross.down = blocks.nearest_in_column(bomb.x, static_cast<u16>(bomb.y - 1), limit).value_or(limit);
+    }
+
+    return cross;
+}
+
+template<std::size_t MaxPlayers>
+Turn BasicGameEngine<MaxPlayers>::next_turn(std::span<const Action> actions) {
+    auto pending = players.pending();
+    for (std::size_t id = 0; id < pending.size(); ++id)
+        pending[id] = id < std::min(actions.size(), players.size()) ? to_pending_action(actions[id]) : PendingAction::NONE;
+    return simulate();
+}
+
+template<std::size_t MaxPlayers>
+Turn BasicGameEngine<MaxPlayers>::next_turn(std::span<const PendingAction> actions) {
+    auto pending = players.pending();
+    const std::size_t count = std::min(actions.size(), players.size());
+    std::fill(pending.begin(), pending.end(), PendingAction::NONE);
+    std::copy(actions.begin(), actions.begin() + static_cast<std::ptrdiff_t>(count), pending.begin());
+    return simulate();
+}
+
+template<std::size_t MaxPlayers>
+Turn BasicGameEngine<MaxPlayers>::simulate() {
+    std::vector<Event::Event> events{};
+    std::vector<Cell> blocks_to_destroy{};
+    const auto alive = players.alive();
+
+    /* Explosions -- all of them see the board as it was at the beginning of the turn */
+    bombs.take(turn + 1u, exploding);
+    for (const BombWheel::Bomb &bomb : exploding) {
+        const Cross cross = explosion_range(bomb.position);
+        Event::BombExploded event{};
+        event.get<"id">() = bomb.id;
+
+        PlayerMask hit = occupancy.in_row(bomb.position.y, cross.left, cross.right);
+        hit |= occupancy.in_column(bomb.position.x, cross.down, cross.up);
+        hit.for_each([&](PlayerId id) {
+            event.get<"robots_destroyed">().push_back(id);
+            alive[id] = 0;
+        });
+
+        const Cell ends[] = {
+            bomb.position,
+            Cell{cross.left, bomb.position.y},
+            Cell{cross.right, bomb.position.y},
+            Cell{bomb.position.x, cross.down},
+            Cell{bomb.position.x, cross.up}
+        };
+        for (std::size_t i = 0; i < std::size(ends); ++i) {
+            // The cell of the bomb is an end of every arm if the radius is 0 or there is a block on it.
+            if (i > 0 && ends[i] == bomb.position)
+                continue;
+            if (blocks.has_block(ends[i].x, ends[i].y)) {
+                event.get<"blocks_destroyed">().push_back(to_position(ends[i]));
+                blocks_to_destroy.push_back(ends[i]);
+            }
+        }
+
+        events.push_back(std::move(event));
+    }
+
+    for (const Cell cell : blocks_to_destroy)
+        blocks.destroy(cell.x, cell.y);
+
+    /*
+        Robots -- the death counts are updated in a branchless pass over a single column.
+        Both loops run over every slot, the absent ones masked out: a slot which is
+        not present is not alive either, so it neither dies nor gets respawned.
+    */
+    const auto present = std::as_const(players).present();
+    const auto death_count = players.death_count();
+    for (std::size_t id = 0; id < players.slots(); ++id)
+        death_count[id] += static_cast<Score>(present[id] - alive[id]);
+
+    const auto pending = players.pending();
+    for (std::size_t id = 0; id < players.slots(); ++id) {
+        if (!present[id])
+            continue;
+        if (!alive[id]) {
+            alive[id] = 1;
+            place_robot(static_cast<PlayerId>(id), random_cell());
+            events.push_back(player_moved(static_cast<PlayerId>(id), players.position(id)));
+        } else if (pending[id] != PendingAction::NONE) {
+            handle_action(static_cast<PlayerId>(id), pending[id], events);
+        }
+    }
+
+    return make_turn(++turn, std::move(events));
+}
+
+template<std::size_t MaxPlayers>
+void BasicGameEngine<MaxPlayers>::handle_action(PlayerId id, PendingAction action, std::vector<Event::Event> &events) {
+    const Cell position = players.position(id);
+    Cell target = position;
+
+    switch (action) {
+        case PendingAction::NONE:
+            return;
+        case PendingAction::PLACE_BOMB: {
+            bombs.arm(next_bomb_id, position, turn + 1u);
+
+            Event::BombPlaced event{};
+            event.get<"id">() = next_bomb_id++;
+            event.get<"position">() = to_position(position);
+            events.push_back(std::move(event));
+            return;
+        }
+        case PendingAction::PLACE_BLOCK:
+            if (blocks.place(position.x, position.y)) {
+                Event::BlockPlaced event{};
+                event.get<"position">() = to_position(position);
+                events.push_back(std::move(event));
+            }
+            return;
+        case PendingAction::MOVE_UP:
+            if (position.y + 1 >= parameters.size_y)
+                return;
+            ++target.y;
+            break;
+        case PendingAction::MOVE_RIGHT:
+            if (position.x + 1 >= parameters.size_x)
+                return;
+            ++target.x;
+            break;
+        case PendingAction::MOVE_DOWN:
+            if (position.y == 0)
+                return;
+            --target.y;
+            break;
+        case PendingAction::MOVE_LEFT:
+            if (position.x == 0)
+                return;
+            --target.x;
+            break;
+    }
+
+    if (blocks.has_block(target.x, target.y))
+        return;
+
+    place_robot(id, target);
+    events.push_back(player_moved(id, target));
+}
+
+template<std::size_t MaxPlayers>
+GameEnded BasicGameEngine<MaxPlayers>::end() const {
+    GameEnded result{};
+    const auto death_count = players.death_count();
+    for (std::size_t id = 0; id < players.size(); ++id)
+        result.get<"scores">().insert({static_cast<PlayerId>(id), death_count[id]});
+    return result;
+}
+
+template<std::size_t MaxPlayers>
+GameHistory::TurnInfo BasicGameEngine<MaxPlayers>::state() const {
+    GameHistory::TurnInfo result{};
+    result.turn = turn;
+    for (std::size_t id = 0; id < players.size(); ++id) {
+        result.positions.push_back(players.position(id));
+        result.death_count.push_back(players.death_count()[id]);
+    }
+    bombs.for_each([&](const BombWheel::Bomb &bomb) {
+        result.bombs.push_back(bomb);
+    });
+    std::sort(result.bombs.begin(), result.bombs.end(), [](const BombWheel::Bomb &a, const BombWheel::Bomb &b) {
+        return a.id < b.id;
+    });
+    result.blocks = blocks;
+    return result;
+}
+
+/* The supported capacities -- GameEngine picks among them. */
+template class BasicGameEngine<DYNAMIC_PLAYERS>;
+template class BasicGameEngine<GameEngine::FIXED_PLAYERS>;
+
+GameEngine::Variant GameEngine::make(const ServerParameters &parameters, Random &random) {
+    if (parameters.players_count <= FIXED_PLAYERS)
+        return Variant{std::in_place_type<BasicGameEngine<FIXED_PLAYERS>>, parameters, random};
+    return Variant{std::in_place_type<BasicGameEngine<DYNAMIC_PLAYERS>>, parameters, random};
+}
+
+} // namespace SK
@@ -0,0 +1,162 @@
+#ifndef __SK_GAME_ENGINE_H__
+#define __SK_GAME_ENGINE_H__
+
+#include <messages/client_messages.h>
+#include <messages/common.h>
+#include <messages/server_messages.h>
+
+#include <cstddef>  // std::size_t
+#include <optional>
+#include <span>
+#include <variant>
+#include <vector>
+
+#include "board.h"
+#include "bomb_wheel.h"
+#include "game_history.h"
+#include "occupancy.h"
+#include "player_table.h"
+#include "random.h"
+#include "server_state.h"
+
+namespace SK {
+
+/*
+    BasicGameEngine -- simulates a single game according to the rules
+    from the specification. It takes the actions of the players
+    for a turn and produces the message describing what happened.
+
+    MaxPlayers bounds the number of players at compile time (see PlayerTable).
+    The definitions live in game_engine.cpp, which instantiates the engine
+    for the supported capacities.
+*/
+template<std::size_t MaxPlayers = DYNAMIC_PLAYERS>
+class BasicGameEngine {
+public:
+    using Action = std::optional<ClientMessage>;
+
+    /* The range of an explosion -- inclusive bounds of both arms of the cross. */
+    struct Cross {
+        Cell center;
+        u16 left;
+        u16 right;
+        u16 down;
+        u16 up;
+    };
+
+private:
+    const ServerParameters parameters;
+    Random &random;
+
+    u16 turn = 0;
+    BombId next_bomb_id = 0;
+
+    PlayerTable<MaxPlayers> players;
+    BombWheel bombs;
+    BlockBoard blocks;
+    Occupancy occupancy;
+
+    std::vector<BombWheel::Bomb> exploding{};
+
+public:
+    /* The generator is shared between consecutive games, hence taken by reference. */
+    BasicGameEngine(const ServerParameters &parameters_, Random &random_);
+
+    /* Places the robots and the initial blocks -- the turn 0. */
+    Turn start();
+
+    /* Simulates the next turn. actions[i] is the last action of the player with ID i, if any. */
+    Turn next_turn(std::span<const Action> actions);
+    Turn next_turn(std::span<const PendingAction> actions);
+
+    bool finished() const {
+        return turn >= parameters.game_length;
+    }
+
+    GameEnded end() const;
+
+    u16 current_turn() const {
+        return turn;
+    }
+
+    const PlayerTable<MaxPlayers> &get_players() const {
+        return players;
+    }
+
+    const BombWheel &get_bombs() const {
+        return bombs;
+    }
+
+    const BlockBoard &get_blocks() const {
+        return blocks;
+    }
+
+    /* The cells covered by an explosion of a bomb placed on the cell. */
+    Cross explosion_range(Cell bomb) const;
+
+    /* What the events so far describe -- see GameHistory. */
+    GameHistory::TurnInfo state() const;
+
+private:
+    Cell random_cell();
+    void place_robot(PlayerId id, Cell cell);
+
+    Turn simulate();
+    void handle_action(PlayerId id, PendingAction action, std::vector<Event::Event> &events);
+};
+
+/*
+    GameEngine -- the engine of a game, chosen by its number of players: one
+    with a fixed capacity, whose loops over the players are bounded at compile
+    time, if they fit in it, and the general one otherwise. The choice is
+    made once per game, and every call is dispatched on it once per turn.
+*/
+class GameEngine {
+public:
+    using Action = std::optional<ClientMessage>;
+
+    constexpr static std::size_t FIXED_PLAYERS = 16;
+
+private:
+    using Variant = std::variant<BasicGameEngine<FIXED_PLAYERS>, BasicGameEngine<DYNAMIC_PLAYERS>>;
+
+    Variant engine;
+
+    static Variant make(const ServerParameters &parameters, Random &random);
+
+public:
+    GameEngine(const ServerParameters &parameters, Random &random)
+    : engine{make(parameters, random)} {}
+
+    Turn start() {
+        return std::visit([](auto &game) { return game.start(); }, engine);
+    }
+
+    Turn next_turn(std::span<const Action> actions) {
+        return std::visit([&](auto &game) { return game.next_turn(actions); }, engine);
+    }
+
+    Turn next_turn(std::span<const PendingAction> actions) {
+        return std::visit([&](auto &game) { return game.next_turn(actions); }, engine);
+    }
+
+    bool finished() const {
+        return std::visit([](const auto &game) { return game.finished(); }, engine);
+    }
+
+    GameEnded end() const {
+        return std::visit([](const auto &game) { return game.end(); }, engine);
+    }
+
+    u16 current_turn() const {
+        return std::visit([](const auto &game) { return game.current_turn(); }, engine);
+    }
+
+    GameHistory::TurnInfo state() const {
+        return std::visit([](const auto &game) { return game.state(); }, engine);
+    }
+};
+
+} // namespace SK
+
+#endif // __SK_GAME_ENGINE_H__
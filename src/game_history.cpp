@@ -0,0 +1,132 @@
+#include "game_history.h"
+#include "occupancy.h"
+
+#include <algorithm>    // std::lower_bound, std::upper_bound, std::max
+#include <stdexcept>
+#include <variant>
+
+namespace SK {
+
+namespace {
+
+Cell to_cell(const Position &position) {
+    return Cell{position.get<"x">(), position.get<"y">()};
+}
+
+} // anonymous namespace
+
+bool GameHistory::TurnInfo::operator==(const TurnInfo &other) const {
+    if (turn != other.turn || positions != other.positions || death_count != other.death_count || bombs != other.bombs)
+        return false;
+    if (blocks.count() != other.blocks.count())
+        return false;
+    bool same = true;
+    blocks.for_each([&](u16 x, u16 y) {
+        same = same && other.blocks.has_block(x, y);
+    });
+    return same;
+}
+
+GameHistory::GameHistory(u8 players_count, u16 size_x, u16 size_y, u16 bomb_timer_)
+// Mirrors BombWheel -- a bomb with no timer waits one turn.
+: bomb_timer{bomb_timer_ ? bomb_timer_ : u16{1}}
+{
+    current.positions.assign(players_count, Cell{0, 0});
+    current.death_count.assign(players_count, 0);
+    current.blocks = BlockBoard{size_x, size_y};
+}
+
+void GameHistory::apply(TurnInfo &state, const Turn &turn) const {
+    const u16 number = turn.get<"turn">();
+    PlayerMask destroyed{};
+
+    for (const Event::Event &event : turn.get<"events">()) {
+        if (const auto *placed = std::get_if<Event::BombPlaced>(&event)) {
+            const u32 expiry = u32{number} + bomb_timer;
+            state.bombs.push_back(BombWheel::Bomb{placed->get<"id">(), to_cell(placed->get<"position">()), expiry});
+        } else if (const auto *exploded = std::get_if<Event::BombExploded>(&event)) {
+            const BombId id = exploded->get<"id">();
+            auto it = std::lower_bound(
+                state.bombs.begin(), state.bombs.end(), id,
+                [](const BombWheel::Bomb &bomb, BombId value) { return bomb.id < value; }
+            );
+            if (it != state.bombs.end() && it->id == id)
+                state.bombs.erase(it);
+
+            for (const PlayerId robot : exploded->get<"robots_destroyed">())
+                destroyed.set(robot);
+            for (const Position &block : exploded->get<"blocks_destroyed">())
+                state.blocks.destroy(block.get<"x">(), block.get<"y">());
+        } else if (const auto *moved = std::get_if<Event::PlayerMoved>(&event)) {
+            const PlayerId id = moved->get<"id">();
+            if (id >= state.positions.size())
+                throw std::out_of_range{"[GameHistory: apply] The player ID exceeds the number of players."};
+            state.positions[id] = to_cell(moved->get<"position">());
+        } else if (const auto *block = std::get_if<Event::BlockPlaced>(&event)) {
+            state.blocks.place(block->get<"position">().get<"x">(), block->get<"position">().get<"y">());
+        }
+    }
+
+    // A robot hit by several bombs in the same turn dies only once.
+    destroyed.for_each([&](PlayerId id) {
+        ++state.death_count.at(id);
+    });
+    state.turn = number;
+}
+
+GameHistory::Keyframe GameHistory::snapshot() const {
+    Keyframe result{current.turn, current.positions, current.death_count, current.bombs, {}};
+    result.blocks.reserve(current.blocks.count());
+    current.blocks.for_each([&](u16 x, u16 y) {
+        result.blocks.push_back(Cell{x, y});
+    });
+    return result;
+}
+
+void GameHistory::record(const Turn &turn) {
+    if (turn.get<"turn">() != deltas.size())
+        throw std::invalid_argument{"[GameHistory: record] Turns have to be recorded in order."};
+
+    apply(current, turn);
+    deltas.push_back(turn);
+
+    events_since_keyframe += turn.get<"events">().size();
+    const std::size_t keyframe_size = current.positions.size() + current.bombs.size() + current.blocks.count();
+    if (events_since_keyframe >= std::max(keyframe_size, MIN_KEYFRAME_DISTANCE)) {
+        keyframes.push_back(snapshot());
+        events_since_keyframe = 0;
+    }
+}
+
+GameHistory::TurnInfo GameHistory::state_at(u16 turn) const {
+    if (turn >= deltas.size())
+        throw std::out_of_range{"[GameHistory: state_at] The turn has not been recorded yet."};
+
+    TurnInfo result{};
+    result.blocks = BlockBoard{current.blocks.width(), current.blocks.height()};
+    std::size_t next_delta = 0;
+
+    auto keyframe = std::upper_bound(
+        keyframes.begin(), keyframes.end(), turn,
+        [](u16 value, const Keyframe &frame) { return value < frame.turn; }
+    );
+    if (keyframe != keyframes.begin()) {
+        --keyframe;
+        result.turn = keyframe->turn;
+        result.positions = keyframe->positions;
+        result.death_count = keyframe->death_count;
+        result.bombs = keyframe->bombs;
+        for (const Cell cell : keyframe->blocks)
+            result.blocks.place(cell.x, cell.y);
+        next_delta = keyframe->turn + std::size_t{1};
+    } else {
+        result.positions.assign(current.positions.size(), Cell{0, 0});
+        result.death_count.assign(current.death_count.size(), 0);
+    }
+
+    for (; next_delta <= turn; ++next_delta)
+        apply(result, deltas[next_delta]);
+    return result;
+}
+
+} // namespace SK
@@ -0,0 +1,90 @@
+#ifndef __SK_GAME_HISTORY_H__
+#define __SK_GAME_HISTORY_H__
+
+#include <messages/common.h>
+#include <messages/server_messages.h>
+
+#include <cstddef>  // std::size_t
+#include <vector>
+
+#include "board.h"
+#include "bomb_wheel.h"
+
+namespace SK {
+
+/*
+    GameHistory -- every turn of a game, stored as the events of the turn
+    (which is exactly what changed since the previous one) plus a sparse
+    set of keyframes holding the full state at some turns.
+
+    A keyframe is only taken once the events recorded since the previous one
+    outweigh it, so the memory used is proportional to the number of events,
+    not to the number of turns times the size of the board. The state at any
+    turn is rebuilt by replaying the events since the nearest keyframe.
+
+    The state is what a client rebuilds from the messages -- replaying an input
+    trace checks it against the state of the engine (see replay_input_trace()).
+*/
+class GameHistory {
+public:
+    struct TurnInfo {
+        u16 turn = 0;
+        std::vector<Cell> positions;
+        std::vector<Score> death_count;
+        std::vector<BombWheel::Bomb> bombs; // by increasing IDs
+        BlockBoard blocks;
+
+        bool operator==(const TurnInfo &other) const;
+    };
+
+private:
+    struct Keyframe {
+        u16 turn;
+        std::vector<Cell> positions;
+        std::vector<Score> death_count;
+        std::vector<BombWheel::Bomb> bombs;
+        std::vector<Cell> blocks;
+    };
+
+    // Keyframes are not worth taking for tiny states.
+    constexpr static std::size_t MIN_KEYFRAME_DISTANCE = 64;
+
+private:
+    u16 bomb_timer = 1;
+    std::vector<Turn> deltas{};
+    std::vector<Keyframe> keyframes{};
+    TurnInfo current{};
+    std::size_t events_since_keyframe = 0;
+
+public:
+    GameHistory() = default;
+    GameHistory(u8 players_count, u16 size_x, u16 size_y, u16 bomb_timer_);
+
+    /* Turns have to be recorded in order, starting from the turn 0. */
+    void record(const Turn &turn);
+
+    /* The number of turns recorded. */
+    std::size_t size() const {
+        return deltas.size();
+    }
+
+    const Turn &delta(u16 turn) const {
+        return deltas.at(turn);
+    }
+
+    /* The state after the last recorded turn. */
+    const TurnInfo &latest() const {
+        return current;
+    }
+
+    /* The state after the given turn. */
+    TurnInfo state_at(u16 turn) const;
+
+private:
+    void apply(TurnInfo &state, const Turn &turn) const;
+    Keyframe snapshot() const;
+};
+
+} // namespace SK
+
+#endif // __SK_GAME_HISTORY_H__
@@ -0,0 +1,142 @@
+#include "game_recording.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>    // std::max
+#include <cerrno>
+#include <cstring>      // std::memcpy, strerror
+#include <stdexcept>
+#include <variant>
+
+namespace SK {
+
+GameRecorder::GameRecorder(const std::string &path) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1)
+        throw std::runtime_error{"[GameRecorder: GameRecorder] " + std::string{strerror(errno)}};
+
+    try {
+        reserve(INITIAL_SIZE);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    append(std::span<const std::byte>{reinterpret_cast<const std::byte*>(&Recording::MAGIC), sizeof(Recording::MAGIC)});
+}
+
+GameRecorder::~GameRecorder() {
+    try {
+        const Recording::Footer footer{turns.size(), ended.value_or(size), size, Recording::MAGIC};
+        append(std::span<const std::byte>{reinterpret_cast<const std::byte*>(turns.data()), turns.size() * sizeof(u64)});
+        append(std::span<const std::byte>{reinterpret_cast<const std::byte*>(&footer), sizeof(footer)});
+    } catch (const std::exception&) {
+        // The file cannot grow -- it is left without the index, which the replay refuses.
+    }
+
+    ::munmap(memory, mapped);
+    // The mapping has been grown ahead of the messages.
+    [[maybe_unused]] const int result = ::ftruncate(fd, static_cast<off_t>(size));
+    ::close(fd);
+}
+
+void GameRecorder::reserve(std::size_t count) {
+    if (size + count <= mapped)
+        return;
+
+    const std::size_t grown = std::max({mapped * 2, size + count, INITIAL_SIZE});
+    // Allocated for real rather than left sparse: a full disk is an error here, not a SIGBUS in append().
+    if (const int error = ::posix_fallocate(fd, static_cast<off_t>(mapped), static_cast<off_t>(grown - mapped)))
+        throw std::runtime_error{"[GameRecorder: reserve] " + std::string{strerror(error)}};
+
+    void *result = memory
+        ? ::mremap(memory, mapped, grown, MREMAP_MAYMOVE)
+        : ::mmap(nullptr, grown, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (result == MAP_FAILED)
+        throw std::runtime_error{"[GameRecorder: reserve] " + std::string{strerror(errno)}};
+    memory = static_cast<std::byte*>(result);
+    mapped = grown;
+}
+
+void GameRecorder::append(std::span<const std::byte> bytes) {
+    reserve(bytes.size());
+    std::memcpy(memory + size, bytes.data(), bytes.size());
+    size += bytes.size();
+}
+
+void GameRecorder::record(const ServerMessage &message, std::span<const std::byte> bytes) {
+    if (std::holds_alternative<Turn>(message))
+        turns.push_back(size);
+    else if (std::holds_alternative<GameEnded>(message))
+        ended = size;
+    append(bytes);
+}
+
+GameRecording::GameRecording(const std::string &path) {
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        throw std::runtime_error{"[GameRecording: GameRecording] " + std::string{strerror(errno)}};
+
+    struct stat status{};
+    void *result = MAP_FAILED;
+    if (::fstat(fd, &status) == 0 && status.st_size > 0) {
+        size = static_cast<std::size_t>(status.st_size);
+        result = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    if (result == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error{"[GameRecording: GameRecording] The file cannot be mapped."};
+    }
+    memory = static_cast<const std::byte*>(result);
+
+    u64 magic = 0;
+    if (size >= sizeof(magic) + sizeof(footer)) {
+        std::memcpy(&magic, memory, sizeof(magic));
+        std::memcpy(&footer, memory + size - sizeof(footer), sizeof(footer));
+    }
+
+    bool valid = magic == Recording::MAGIC
+        && footer.magic == Recording::MAGIC
+        && footer.index <= size - sizeof(footer)
+        && footer.turns == (size - sizeof(footer) - footer.index) / sizeof(u64)
+        && footer.index + footer.turns * sizeof(u64) + sizeof(footer) == size
+        && sizeof(magic) <= footer.ended && footer.ended <= footer.index;
+    // The turns have to follow one another within the messages.
+    for (std::size_t i = 0; valid && i < turns(); ++i)
+        valid = (i ? offset(i - 1) : sizeof(magic)) <= offset(i) && offset(i) <= footer.ended;
+
+    if (!valid) {
+        ::munmap(const_cast<std::byte*>(memory), size);
+        ::close(fd);
+        throw std::runtime_error{"[GameRecording: GameRecording] Not a recording of a game, or an unfinished one."};
+    }
+}
+
+GameRecording::~GameRecording() {
+    ::munmap(const_cast<std::byte*>(memory), size);
+    ::close(fd);
+}
+
+u64 GameRecording::offset(std::size_t number) const {
+    u64 result = 0;
+    std::memcpy(&result, memory + footer.index + number * sizeof(u64), sizeof(result));
+    return result;
+}
+
+Recording::Range GameRecording::prologue() const {
+    return Recording::Range{sizeof(Recording::MAGIC), turns() ? offset(0) : footer.ended};
+}
+
+Recording::Range GameRecording::turn(std::size_t number) const {
+    if (number >= turns())
+        throw std::out_of_range{"[GameRecording: turn] There is no such turn."};
+    return Recording::Range{offset(number), number + 1 < turns() ? offset(number + 1) : footer.ended};
+}
+
+Recording::Range GameRecording::epilogue() const {
+    return Recording::Range{footer.ended, footer.index};
+}
+
+} // namespace SK
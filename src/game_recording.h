@@ -0,0 +1,124 @@
+#ifndef __SK_GAME_RECORDING_H__
+#define __SK_GAME_RECORDING_H__
+
+#include <messages/common.h>
+#include <messages/server_messages.h>
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace SK {
+
+/*
+    A recording of a game is a file holding the very bytes its observers
+    have been sent -- Hello, GameStarted, every Turn and GameEnded -- one
+    after another, so that any part of it can be sent out as it is. The
+    messages are followed by the offset of every turn and by a footer:
+
+        [MAGIC] [messages] [u64 offset of turn 0] ... [u64 offset of turn n - 1] [Footer]
+
+    The integers are in the byte order of the host which has recorded
+    the game -- the recordings are not meant to be moved between hosts.
+*/
+namespace Recording {
+
+constexpr u64 MAGIC = 0x3130434552524b53;   // "SKRREC01"
+
+struct Footer {
+    u64 turns;  // the number of offsets in the index
+    u64 ended;  // where GameEnded starts, that is where the last turn ends
+    u64 index;  // where the index starts, that is where the messages end
+    u64 magic;
+};
+
+/* A part of the file, [begin, end). */
+struct Range {
+    u64 begin = 0;
+    u64 end = 0;
+
+    std::size_t size() const {
+        return static_cast<std::size_t>(end - begin);
+    }
+};
+
+} // namespace Recording
+
+/*
+    GameRecorder -- writes a recording through a shared mapping of the file,
+    so that appending a message is a copy into the page cache. The file
+    grows by doubling the mapping, and is cut to size once the recorder is done.
+*/
+class GameRecorder {
+private:
+    constexpr static std::size_t INITIAL_SIZE = std::size_t{1} << 20;
+
+    int fd = -1;
+    std::byte *memory = nullptr;
+    std::size_t mapped = 0;
+    std::size_t size = 0;
+
+    std::vector<u64> turns{};
+    std::optional<u64> ended = std::nullopt;
+
+public:
+    explicit GameRecorder(const std::string &path);
+
+    GameRecorder(const GameRecorder&) = delete;
+    GameRecorder &operator=(const GameRecorder&) = delete;
+
+    /* Writes out the index and the footer. */
+    ~GameRecorder();
+
+    /* The bytes of Hello, which is not published to the feed. */
+    void append(std::span<const std::byte> bytes);
+    void record(const ServerMessage &message, std::span<const std::byte> bytes);
+
+private:
+    void reserve(std::size_t count);
+};
+
+/* GameRecording -- a recording mapped for reading, with its turns found in O(1). */
+class GameRecording {
+private:
+    int fd = -1;
+    const std::byte *memory = nullptr;
+    std::size_t size = 0;
+    Recording::Footer footer{};
+
+public:
+    explicit GameRecording(const std::string &path);
+
+    GameRecording(const GameRecording&) = delete;
+    GameRecording &operator=(const GameRecording&) = delete;
+
+    ~GameRecording();
+
+    /* For sendfile(). */
+    int native_handle() const {
+        return fd;
+    }
+
+    std::size_t turns() const {
+        return static_cast<std::size_t>(footer.turns);
+    }
+
+    /* Everything before the first turn -- Hello and GameStarted. */
+    Recording::Range prologue() const;
+    Recording::Range turn(std::size_t number) const;
+    /* GameEnded, if the game has ended at all. */
+    Recording::Range epilogue() const;
+
+    std::span<const std::byte> bytes(Recording::Range range) const {
+        return std::span<const std::byte>{memory + range.begin, range.size()};
+    }
+
+private:
+    u64 offset(std::size_t number) const;
+};
+
+} // namespace SK
+
+#endif // __SK_GAME_RECORDING_H__
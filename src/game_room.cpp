@@ -0,0 +1,617 @@
+#include "game_room.h"
+#include "auxiliary.h"
+#include "game_engine.h"
+#include "room_checkpoint.h"
+
+#include <messages/serializer.h>
+#include <messages/server_messages.h>
+#include <utilities/logger.h>
+#include <utilities/tracer.h>
+
+#include <algorithm>    // std::erase, std::fill
+#include <array>
+#include <chrono>
+#include <cstring>      // std::memmove
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>      // std::exchange
+#include <variant>
+
+namespace SK {
+
+GameRoom::GameRoom(
+    const ServerParameters &parameters_,
+    EventLoop &event_loop_,
+    const SlowClientPolicy &slow_clients_,
+    ConnectionStats &connection_stats_,
+    TurnStats &stats_,
+    std::optional<SharedRing> &&shared_feed_,
+    const std::string &recording_prefix_,
+    const std::string &input_trace_path
+)
+: parameters{parameters_}
+, event_loop{event_loop_}
+, random{parameters_.seed ? *parameters_.seed : get_seed()}
+, feed{std::make_shared<TurnFeed>()}
+, shared_feed{std::move(shared_feed_)}
+, recording_prefix{recording_prefix_}
+, vacancies{parameters_.players_count}
+, slow_clients{slow_clients_}
+, connection_stats{connection_stats_}
+, stats{stats_}
+{
+    Hello message{};
+    message.get<"server_name">() = parameters.server_name;
+    message.get<"players_count">() = parameters.players_count;
+    message.get<"size_x">() = parameters.size_x;
+    message.get<"size_y">() = parameters.size_y;
+    message.get<"game_length">() = parameters.game_length;
+    message.get<"explosion_radius">() = parameters.explosion_radius;
+    message.get<"bomb_timer">() = parameters.bomb_timer;
+
+    VectorInserter inserter{hello};
+    Serializer<ServerMessage>::serialize(message, inserter);
+    // The observers attaching mid-game get the state of the next one.
+    if (shared_feed)
+        shared_feed->set_preamble(hello);
+    if (!input_trace_path.empty())
+        input_trace.emplace(input_trace_path);
+}
+
+bool GameRoom::reserve() {
+    std::size_t current = vacancies.load(std::memory_order_relaxed);
+    while (current) {
+        if (vacancies.compare_exchange_weak(current, current - 1, std::memory_order_relaxed))
+            return true;
+    }
+    return false;
+}
+
+void GameRoom::update_vacancies() {
+    std::size_t waiting = roster.entries.size();
+    for (const auto &client : clients)
+        if (client->connected && !client->player)
+            ++waiting;
+
+    const std::size_t capacity = parameters.players_count;
+    vacancies.store(in_game || waiting >= capacity ? 0 : capacity - waiting, std::memory_order_relaxed);
+}
+
+void GameRoom::admit(StreamSocket &&socket) {
+    String address{};
+    try {
+        address = socket.peer_address();
+    } catch (const std::runtime_error&) {
+        // The client has already gone.
+        return;
+    }
+
+    auto client = std::make_shared<Client>(AsyncSocket{std::move(socket), event_loop}, std::move(address));
+    clients.push_back(client);
+    update_vacancies();
+
+    spawn(listen(client));
+    spawn(serve(std::move(client)));
+}
+
+/* Serialises the message once for all the clients. */
+const TurnFeed::Entry &GameRoom::publish(ServerMessage &&message) {
+    const auto serialization_start = EventLoop::Clock::now();
+    std::vector<std::byte> bytes{};
+    VectorInserter inserter{bytes};
+    Serializer<ServerMessage>::serialize(message, inserter);
+    if (std::holds_alternative<Turn>(message) && !restoring)
+        stats.serialization.record(TurnStats::microseconds(EventLoop::Clock::now() - serialization_start));
+
+    // A message too long for the shared ring is left out there -- its readers see the gap in the sequence.
+    if (shared_feed && !shared_feed->write(bytes))
+        log_warning("shared_feed_dropped", {{"length", bytes.size()}});
+    if (recorder) {
+        try {
+            recorder->record(message, bytes);
+        } catch (const std::runtime_error &e) {
+            // Most likely the disk is full -- the game goes on unrecorded.
+            log_error("recording_failed", {{"error", std::string_view{e.what()}}});
+            recorder.reset();
+        }
+    }
+    return feed->publish(std::move(message), std::move(bytes));
+}
+
+/* Observers joining during the game skip the lobby -- so does the recording, which starts with Hello. */
+void GameRoom::start_recording() {
+    if (recording_prefix.empty())
+        return;
+
+    const std::string path = recording_prefix + "-" + std::to_string(games_played) + ".rec";
+    try {
+        recorder.emplace(path);
+        recorder->append(hello);
+    } catch (const std::runtime_error &e) {
+        log_error("recording_failed", {{"path", path}, {"error", std::string_view{e.what()}}});
+        recorder.reset();
+    }
+}
+
+const TurnFeed::Entry &GameRoom::publish_turn(Turn &&turn) {
+    record_delivery();
+    const TurnFeed::Entry &entry = publish(std::move(turn));
+    turn_index = feed->messages().size() - 1;
+    turn_published = EventLoop::Clock::now();
+    return entry;
+}
+
+/* The delivery of the latest turn is over once the next one is due. */
+void GameRoom::record_delivery() {
+    if (turn_delivered)
+        stats.delivery.record(TurnStats::microseconds(*turn_delivered - turn_published));
+    turn_delivered.reset();
+}
+
+void GameRoom::join(Client &client, String &&name) {
+    if (roster.entries.size() >= parameters.players_count)
+        return;
+
+    client.player = static_cast<PlayerId>(roster.entries.size());
+    roster.entries.push_back(PlayerRoster::Entry{name, client.address});
+
+    AcceptedPlayer message{};
+    message.get<"player">().get<"name">() = std::move(name);
+    message.get<"player">().get<"address">() = client.address;
+    publish(std::move(message));
+    update_vacancies();
+
+    if (roster.entries.size() == parameters.players_count && lobby_waiter)
+        event_loop.post(std::exchange(lobby_waiter, nullptr));
+}
+
+void GameRoom::handle_message(Client &client, ClientMessage &&message) {
+    if (Join *join_message = std::get_if<Join>(&message)) {
+        // Join is ignored during the game, as are the other messages in the lobby.
+        if (!in_game && !client.player)
+            join(client, std::move(join_message->get<"name">()));
+    } else if (in_game && client.player) {
+        // Only the last message of a turn counts.
+        actions[*client.player] = to_pending_action(std::optional<ClientMessage>{std::move(message)});
+    }
+}
+
+/*
+    Handles every complete message in the buffer at once. All of them are
+    validated, but of the actions only the last one is handed over -- only
+    the last action of a turn counts anyway. Returns how many bytes have been read.
+*/
+std::size_t GameRoom::parse(Client &client, std::span<std::byte> bytes) {
+    const TraceSpan span{"receive", "connection"};
+    std::optional<ClientMessage> action = std::nullopt;
+    std::size_t parsed = 0;
+
+    while (is_complete_message(bytes.subspan(parsed))) {
+        SimpleConsumer consumer{bytes.subspan(parsed)};
+        auto message = Serializer<ClientMessage>::deserialize(consumer);
+        parsed += consumer.index;
+
+        if (std::holds_alternative<Join>(message))
+            handle_message(client, std::move(message));
+        else
+            action = std::move(message);
+    }
+
+    if (action)
+        handle_message(client, std::move(*action));
+    return parsed;
+}
+
+Task<void> GameRoom::listen(std::shared_ptr<Client> client) {
+    // Kept by the client, so that a partial message goes along when it is handed over.
+    std::array<std::byte, 512> &buffer = client->input;
+    std::size_t &begin = client->input_begin;
+    std::size_t &end = client->input_end;
+
+    try {
+        while (client->connected) {
+            begin += parse(*client, std::span<std::byte>{buffer}.subspan(begin, end - begin));
+
+            // Compacted once per read, and only if a partial message is left at the end of the buffer.
+            if (begin == end) {
+                begin = end = 0;
+            } else if (end == buffer.size()) {
+                std::memmove(
+                    reinterpret_cast<void*>(buffer.data()),
+                    reinterpret_cast<const void*>(buffer.data() + begin),
+                    end - begin
+                );
+                end -= begin;
+                begin = 0;
+            }
+
+            const std::size_t received = co_await client->socket.read_some(std::span<std::byte>{buffer}.subspan(end));
+            if (!received)
+                break;
+            end += received;
+        }
+    } catch (const std::exception&) {
+        // An invalid message or a broken connection -- either way, the client is gone.
+    }
+
+    disconnect(*client);
+}
+
+/* Writes out everything gathered for the client so far. */
+Task<bool> GameRoom::flush(Client &client, std::vector<std::byte> &buffer) {
+    const TraceSpan span{"send", "connection"};
+    const bool sent = co_await client.socket.write_all(std::span<std::byte>{buffer});
+    buffer.clear();
+    co_return sent;
+}
+
+/* Applies the policy to a client lag messages behind the feed -- returns false if it has to be evicted. */
+bool GameRoom::tolerate(Client &client, std::size_t lag) {
+    // A client which has come in the middle of a game is not slow while it catches up on the turns so far.
+    const bool catching_up = !client.caught_up;
+    client.caught_up = client.caught_up || lag == 0;
+    if (!slow_clients.max_lag || lag <= slow_clients.max_lag || catching_up)
+        return true;
+
+    if (!client.slow) {
+        client.slow = true;
+        connection_stats.slow.fetch_add(1, std::memory_order_relaxed);
+        log_warning("client_slow", {{"address", client.address}, {"lag", lag}});
+    }
+
+    if (slow_clients.action != SlowClientPolicy::Action::EVICT)
+        return true;
+    connection_stats.evicted.fetch_add(1, std::memory_order_relaxed);
+    log_warning("client_evicted", {{"address", client.address}, {"lag", lag}});
+    return false;
+}
+
+/* Wakes serve() up, whatever it waits for -- it finds the client disconnected and lets go of it. */
+void GameRoom::disconnect(Client &client) {
+    client.connected = false;
+    client.socket.cancel();
+    if (client.feed && client.cursor)
+        client.feed->cancel(*client.cursor);
+}
+
+/* A client stuck on a full socket buffer does not get to check its lag by itself. */
+void GameRoom::check_lagging() {
+    const std::size_t head = feed->messages().size();
+    for (const auto &client : clients) {
+        if (client->connected && client->feed == feed.get() && !tolerate(*client, head - client->position))
+            disconnect(*client);
+    }
+}
+
+Task<void> GameRoom::serve(std::shared_ptr<Client> client) {
+    // What the client is to be sent, gathered until it has caught up with the feed and written at once.
+    // One taken over from the previous server has got Hello, and more, already.
+    std::vector<std::byte> buffer = client->resume ? std::vector<std::byte>{} : hello;
+    // The index of the latest turn, if it is in the buffer.
+    std::optional<std::size_t> delivering = std::nullopt;
+
+    try {
+        while (client->connected) {
+            // Every game has its own feed -- stay with the room once this one ends.
+            const std::shared_ptr<TurnFeed> current = feed;
+            auto cursor = current->messages().cursor();
+            const bool joined_during_game = in_game;
+            client->feed = current.get();
+            client->cursor = &cursor;
+            client->position = 0;
+            if (client->resume) {
+                // The messages before are the same the previous server has sent.
+                for (std::size_t i = 0; i < *client->resume; ++i)
+                    cursor.next();
+                client->position = cursor.index();
+                client->resume.reset();
+            }
+            // The delivery of the last game is over.
+            delivering.reset();
+            bool game_over = false;
+
+            while (client->connected && !game_over) {
+                if (!buffer.empty() && !cursor.lag()) {
+                    const bool sent = co_await flush(*client, buffer);
+                    if (!sent) {
+                        client->connected = false;
+                        break;
+                    }
+                    if (delivering && current == feed && *delivering == turn_index)
+                        turn_delivered = EventLoop::Clock::now();
+                    delivering.reset();
+                    continue;
+                }
+
+                client->idle = buffer.empty() && !cursor.lag();
+                if (client->idle)
+                    client->position = cursor.index();
+                const TurnFeed::Entry *next = co_await current->next_turn(cursor, event_loop);
+                client->idle = false;
+                if (!client->connected || !next)
+                    break;
+                const TurnFeed::Entry &entry = *next;
+                // A client joining during the game does not need to learn who was in the lobby.
+                if (joined_during_game && std::holds_alternative<AcceptedPlayer>(entry.message))
+                    continue;
+
+                const std::size_t lag = cursor.lag();
+                connection_stats.lag.record(lag);
+                if (!tolerate(*client, lag)) {
+                    client->connected = false;
+                    break;
+                }
+
+                buffer.insert(buffer.end(), entry.bytes.begin(), entry.bytes.end());
+                if (std::holds_alternative<Turn>(entry.message) && cursor.index() - 1 == turn_index)
+                    delivering = turn_index;
+                client->position = cursor.index();
+                game_over = std::holds_alternative<GameEnded>(entry.message);
+            }
+        }
+    } catch (const std::exception&) {
+        client->connected = false;
+    }
+
+    // The feed and the cursor go along with this frame -- nothing may wake it up through them any more.
+    client->feed = nullptr;
+    client->cursor = nullptr;
+    connection_stats.add(client->socket.counters());
+    client->socket.cancel();
+    std::erase(clients, client);
+    update_vacancies();
+}
+
+void GameRoom::start_game() {
+    in_game = true;
+    update_vacancies();
+
+    GameStarted started{};
+    for (std::size_t id = 0; id < roster.entries.size(); ++id) {
+        Player player{};
+        player.get<"name">() = roster.entries[id].name;
+        player.get<"address">() = roster.entries[id].address;
+        started.get<"players">().insert({static_cast<PlayerId>(id), std::move(player)});
+    }
+    start_recording();
+    publish(std::move(started));
+    log_info("game_started", {{"players", roster.entries.size()}, {"clients", clients.size()}});
+
+    actions.assign(parameters.players_count, PendingAction::NONE);
+    played.clear();
+    // The game is determined by the state of the generator and the actions.
+    game_random_state = random.get_state();
+    engine.emplace(parameters, random);
+    const TurnFeed::Entry &start = publish_turn(engine->start());
+    if (input_trace)
+        input_trace->begin(parameters, game_random_state, start.bytes);
+}
+
+/* Plays a turn -- also when a game taken over is played again, which gives the very same messages. */
+void GameRoom::simulate(std::span<const PendingAction> pending) {
+    const auto simulation_start = EventLoop::Clock::now();
+    Turn turn = engine->next_turn(pending);
+    if (!restoring)
+        stats.simulation.record(TurnStats::microseconds(EventLoop::Clock::now() - simulation_start));
+    const TurnFeed::Entry &published = publish_turn(std::move(turn));
+    played.insert(played.end(), pending.begin(), pending.end());
+    if (input_trace)
+        input_trace->turn(pending, published.bytes);
+}
+
+Task<void> GameRoom::play() {
+    std::vector<PendingAction> pending(parameters.players_count, PendingAction::NONE);
+
+    auto deadline = EventLoop::Clock::now();
+    while (!engine->finished()) {
+        deadline += std::chrono::milliseconds{parameters.turn_durations};
+        co_await event_loop.sleep_until(deadline);
+
+        // Between two turns -- the next server plays the rest of the game.
+        if (handover_waiter) {
+            stopped = true;
+            event_loop.post(std::exchange(handover_waiter, nullptr));
+            co_return;
+        }
+
+        const auto woken = EventLoop::Clock::now();
+        stats.jitter.record(TurnStats::microseconds(woken - deadline));
+        trace_instant("tick", "game");
+        const TraceSpan span{"turn", "game"};
+
+        pending.swap(actions);
+        std::fill(actions.begin(), actions.end(), PendingAction::NONE);
+        stats.input.record(TurnStats::microseconds(EventLoop::Clock::now() - woken));
+
+        simulate(pending);
+        check_lagging();
+    }
+    end_game();
+}
+
+void GameRoom::end_game() {
+    record_delivery();
+    const TurnFeed::Entry &ended = publish(engine->end());
+    if (input_trace) {
+        try {
+            input_trace->end(ended.bytes);
+        } catch (const std::runtime_error &e) {
+            log_error("input_trace_failed", {{"error", std::string_view{e.what()}}});
+            input_trace.reset();
+        }
+    }
+    log_info("game_ended", {{"messages", feed->messages().size()}, {"clients", clients.size()}});
+    // Writes out the index of the turns.
+    recorder.reset();
+    ++games_played;
+    engine.reset();
+    played.clear();
+
+    /* Back to the lobby */
+    in_game = false;
+    roster.entries.clear();
+    for (auto &client : clients)
+        client->player.reset();
+    feed = std::make_shared<TurnFeed>();
+    update_vacancies();
+}
+
+Task<void> GameRoom::run() {
+    while (!stopped) {
+        co_await LobbyFull{*this};
+        // A game taken over from the previous server goes on from where it has stopped.
+        if (!engine)
+            start_game();
+        co_await play();
+    }
+}
+
+Task<GameRoom::Handover> GameRoom::hand_over() {
+    co_await HandoverPoint{*this};
+    stopped = true;
+    lobby_waiter = nullptr;
+    vacancies.store(0, std::memory_order_relaxed);
+    // The next server writes them anew -- they have to be let go of before it opens them.
+    recorder.reset();
+    shared_feed.reset();
+
+    RoomCheckpoint checkpoint{};
+    checkpoint.get<"players_count">() = parameters.players_count;
+    checkpoint.get<"size_x">() = parameters.size_x;
+    checkpoint.get<"size_y">() = parameters.size_y;
+    checkpoint.get<"game_length">() = parameters.game_length;
+    checkpoint.get<"explosion_radius">() = parameters.explosion_radius;
+    checkpoint.get<"bomb_timer">() = parameters.bomb_timer;
+    checkpoint.get<"initial_blocks">() = parameters.initial_blocks;
+    checkpoint.get<"random_state">() = engine ? game_random_state : random.get_state();
+    checkpoint.get<"games_played">() = games_played;
+    for (const auto &entry : roster.entries) {
+        Player player{};
+        player.get<"name">() = entry.name;
+        player.get<"address">() = entry.address;
+        checkpoint.get<"roster">().push_back(std::move(player));
+    }
+    checkpoint.get<"in_game">() = engine ? 1 : 0;
+    for (const PendingAction action : played)
+        checkpoint.get<"actions">().push_back(to_underlying(action));
+    if (engine)
+        for (const PendingAction action : actions)
+            checkpoint.get<"pending">().push_back(to_underlying(action));
+
+    Handover handover{};
+    for (const auto &client : clients) {
+        // A client in the middle of a message cannot be resumed at a message boundary.
+        if (client->connected && client->idle && client->feed == feed.get()) {
+            ClientCheckpoint entry{};
+            entry.get<"address">() = client->address;
+            entry.get<"is_player">() = client->player ? 1 : 0;
+            entry.get<"player">() = client->player.value_or(0);
+            entry.get<"position">() = client->position;
+            for (std::size_t i = client->input_begin; i < client->input_end; ++i)
+                entry.get<"input">().push_back(static_cast<u8>(client->input[i]));
+            checkpoint.get<"clients">().push_back(std::move(entry));
+            handover.clients.push_back(client->socket.release());
+        }
+        disconnect(*client);
+    }
+
+    VectorInserter inserter{handover.checkpoint};
+    Serializer<RoomCheckpoint>::serialize(checkpoint, inserter);
+    log_info("room_handed_over", {{"in_game", in_game}, {"clients", handover.clients.size()}, {"dropped", clients.size() - handover.clients.size()}});
+    co_return handover;
+}
+
+void GameRoom::restore(std::span<const std::byte> bytes, std::vector<StreamSocket> &&sockets) {
+    RoomCheckpoint checkpoint{};
+    try {
+        SimpleConsumer consumer{bytes};
+        checkpoint = Serializer<RoomCheckpoint>::deserialize(consumer);
+    } catch (const std::exception &e) {
+        log_warning("restore_failed", {{"error", std::string_view{e.what()}}});
+        return;
+    }
+
+    const auto &roster_entries = checkpoint.get<"roster">();
+    const auto &turns = checkpoint.get<"actions">();
+    const auto &pending = checkpoint.get<"pending">();
+    const auto &client_entries = checkpoint.get<"clients">();
+    const bool game_under_way = checkpoint.get<"in_game">();
+    const std::size_t players_count = parameters.players_count;
+    const bool valid_actions = std::all_of(turns.begin(), turns.end(), [](u8 action) {
+        return action <= to_underlying(PendingAction::MOVE_LEFT);
+    }) && std::all_of(pending.begin(), pending.end(), [](u8 action) {
+        return action <= to_underlying(PendingAction::MOVE_LEFT);
+    });
+    // Anything else would not be the same game -- the room starts afresh then, and the clients have to reconnect.
+    if (checkpoint.get<"players_count">() != parameters.players_count
+        || checkpoint.get<"size_x">() != parameters.size_x
+        || checkpoint.get<"size_y">() != parameters.size_y
+        || checkpoint.get<"game_length">() != parameters.game_length
+        || checkpoint.get<"explosion_radius">() != parameters.explosion_radius
+        || checkpoint.get<"bomb_timer">() != parameters.bomb_timer
+        || checkpoint.get<"initial_blocks">() != parameters.initial_blocks
+        || roster_entries.size() > players_count
+        || (game_under_way && roster_entries.size() != players_count)
+        || turns.size() % players_count
+        || turns.size() / players_count > parameters.game_length
+        || pending.size() != (game_under_way ? players_count : 0)
+        || !valid_actions
+        || client_entries.size() != sockets.size()) {
+        log_warning("restore_failed", {{"error", "The checkpoint does not match the parameters of the room."}});
+        return;
+    }
+
+    random = Random{checkpoint.get<"random_state">()};
+    games_played = checkpoint.get<"games_played">();
+    for (const Player &player : roster_entries) {
+        roster.entries.push_back(PlayerRoster::Entry{player.get<"name">(), player.get<"address">()});
+        AcceptedPlayer message{};
+        message.get<"player">() = player;
+        publish(std::move(message));
+    }
+
+    if (game_under_way) {
+        // The turns played again are the previous server's -- they stay out of the statistics.
+        restoring = true;
+        start_game();
+        std::vector<PendingAction> turn(players_count);
+        for (std::size_t i = 0; i < turns.size(); i += players_count) {
+            for (std::size_t id = 0; id < players_count; ++id)
+                turn[id] = static_cast<PendingAction>(turns[i + id]);
+            simulate(turn);
+        }
+        restoring = false;
+        for (std::size_t id = 0; id < players_count; ++id)
+            actions[id] = static_cast<PendingAction>(pending[id]);
+    }
+
+    const std::size_t published = feed->messages().size();
+    for (std::size_t i = 0; i < client_entries.size(); ++i) {
+        const ClientCheckpoint &entry = client_entries[i];
+        const auto &input = entry.get<"input">();
+        if (entry.get<"position">() > published || input.size() > std::tuple_size_v<decltype(Client::input)>)
+            continue;
+
+        String address = entry.get<"address">();
+        auto client = std::make_shared<Client>(AsyncSocket{std::move(sockets[i]), event_loop}, std::move(address));
+        if (entry.get<"is_player">() && entry.get<"player">() < roster.entries.size())
+            client->player = entry.get<"player">();
+        client->resume = static_cast<std::size_t>(entry.get<"position">());
+        client->caught_up = true;
+        for (const u8 byte : input)
+            client->input[client->input_end++] = static_cast<std::byte>(byte);
+        clients.push_back(client);
+
+        spawn(listen(client));
+        spawn(serve(std::move(client)));
+    }
+    update_vacancies();
+    log_info("room_restored", {{"in_game", in_game}, {"turns", turns.size() / players_count}, {"clients", clients.size()}});
+
+    if (engine && lobby_waiter)
+        event_loop.post(std::exchange(lobby_waiter, nullptr));
+}
+
+} // namespace SK
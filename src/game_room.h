@@ -0,0 +1,230 @@
+#ifndef __SK_GAME_ROOM_H__
+#define __SK_GAME_ROOM_H__
+
+#include <messages/client_messages.h>
+#include <messages/network_string.h>
+#include <network/async_socket.h>
+#include <network/event_loop.h>
+#include <network/stream_socket.h>
+#include <utilities/shared_ring.h>
+#include <utilities/task.h>
+
+#include <array>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <memory>   // std::shared_ptr
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "game_engine.h"
+#include "game_recording.h"
+#include "input_trace.h"
+#include "player_table.h"
+#include "random.h"
+#include "server_state.h"
+#include "turn_feed.h"
+#include "connection_stats.h"
+#include "turn_stats.h"
+
+namespace SK {
+
+/* What to do about a client which has fallen behind the feed by more than max_lag messages. */
+struct SlowClientPolicy {
+    enum class Action : u8 {
+        FLAG,   // only count it
+        EVICT   // disconnect it
+    };
+
+    Action action = Action::FLAG;
+    std::size_t max_lag = 0;    // no limit if 0
+};
+
+/*
+    GameRoom -- an independent game with its own parameters, lobby and state.
+
+    A room lives entirely on the thread of its EventLoop: its clients,
+    the simulation and the broadcast are coroutines on that loop, so none
+    of its state is shared with other threads. The only exception is the
+    number of vacancies, which the RoomManager reads to route newcomers.
+*/
+class GameRoom {
+private:
+    struct Client {
+        AsyncSocket socket;
+        String address;
+        std::optional<PlayerId> player = std::nullopt;
+        bool connected = true;
+        // Where the client is in the feed it is being sent -- and the cursor serve() waits for it with
+        TurnFeed *feed = nullptr;
+        const TurnFeed::Log::Cursor *cursor = nullptr;
+        std::size_t position = 0;
+        bool caught_up = false;
+        bool slow = false;
+        // Sent everything up to the position and waiting for more -- only such a client can be handed over.
+        bool idle = false;
+        // Where a client taken over from the previous server is in the feed -- it has got Hello already.
+        std::optional<std::size_t> resume = std::nullopt;
+
+        // Fits the longest message -- a Join with a name of 255 characters.
+        std::array<std::byte, 512> input{};
+        std::size_t input_begin = 0;
+        std::size_t input_end = 0;
+
+        Client(AsyncSocket &&socket_, String &&address_)
+        : socket{std::move(socket_)}
+        , address{std::move(address_)} {}
+    };
+
+    /* Resumed once the lobby is full. */
+    struct LobbyFull {
+        GameRoom &room;
+
+        bool await_ready() const noexcept {
+            // A game taken over from the previous server is already under way.
+            return room.engine || room.roster.entries.size() >= room.parameters.players_count;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) noexcept {
+            room.lobby_waiter = handle;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    /* Resumed once the room can be handed over -- at once in the lobby, right before the next turn in a game. */
+    struct HandoverPoint {
+        GameRoom &room;
+
+        bool await_ready() const noexcept {
+            return !room.engine;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) noexcept {
+            room.handover_waiter = handle;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+public:
+    /* What the next server needs to take the room over. */
+    struct Handover {
+        std::vector<std::byte> checkpoint;  // a RoomCheckpoint
+        std::vector<StreamSocket> clients;  // in the order of the checkpoint
+    };
+
+private:
+    const ServerParameters parameters;
+    EventLoop &event_loop;
+    Random random;
+
+    std::vector<std::byte> hello{};     // serialised once, as it only depends on the parameters
+    std::shared_ptr<TurnFeed> feed;
+    bool in_game = false;
+    // The feed mirrored for the observers on the same host, if any -- see SharedRing.
+    std::optional<SharedRing> shared_feed;
+    // Every game is recorded to "<recording_prefix>-<number>.rec", unless the prefix is empty.
+    const std::string recording_prefix;
+    std::optional<GameRecorder> recorder = std::nullopt;
+    std::size_t games_played = 0;
+    // The actions of the players, to replay the games with -- see InputTraceWriter.
+    std::optional<InputTraceWriter> input_trace = std::nullopt;
+
+    std::vector<std::shared_ptr<Client>> clients{};
+    PlayerRoster roster{};
+    std::vector<PendingAction> actions{};
+    std::coroutine_handle<> lobby_waiter = nullptr;
+
+    /* The game under way, along with what determines it */
+    std::optional<GameEngine> engine = std::nullopt;
+    u32 game_random_state = 0;
+    std::vector<PendingAction> played{};    // players_count actions per turn
+
+    bool stopped = false;   // handed over to the next server
+    bool restoring = false; // playing a game taken over again -- which is no turn of this server's
+    std::coroutine_handle<> handover_waiter = nullptr;
+
+    std::atomic<std::size_t> vacancies;
+
+    const SlowClientPolicy slow_clients;
+    ConnectionStats &connection_stats;
+
+    /* The latest turn -- when it was published and when the last client got it */
+    TurnStats &stats;
+    std::size_t turn_index = 0;
+    EventLoop::Clock::time_point turn_published{};
+    std::optional<EventLoop::Clock::time_point> turn_delivered = std::nullopt;
+
+public:
+    GameRoom(
+        const ServerParameters &parameters_,
+        EventLoop &event_loop_,
+        const SlowClientPolicy &slow_clients_,
+        ConnectionStats &connection_stats_,
+        TurnStats &stats_,
+        std::optional<SharedRing> &&shared_feed_ = std::nullopt,
+        const std::string &recording_prefix_ = {},
+        const std::string &input_trace_path = {}
+    );
+
+    GameRoom(const GameRoom&) = delete;
+    GameRoom &operator=(const GameRoom&) = delete;
+
+    /* Has to be called on the thread of the room's loop. */
+    void admit(StreamSocket &&socket);
+
+    /* Runs the games one after another, forever. */
+    Task<void> run();
+
+    EventLoop &loop() const {
+        return event_loop;
+    }
+
+    /*
+        An estimate of how many more clients the lobby can take. Thread-safe.
+        reserve() takes a vacancy for a client about to be admitted.
+    */
+    std::size_t get_vacancies() const {
+        return vacancies.load(std::memory_order_relaxed);
+    }
+
+    bool reserve();
+
+    /*
+        Stops the room once it can be handed over and tells the next server
+        how to take it over -- every client sent all it has been due so far
+        goes along, the others are disconnected. Has to be awaited on the loop.
+    */
+    Task<Handover> hand_over();
+
+    /* Takes over a room from the previous server. Has to be called on the thread of the loop. */
+    void restore(std::span<const std::byte> checkpoint, std::vector<StreamSocket> &&sockets);
+
+private:
+    Task<void> serve(std::shared_ptr<Client> client);
+    Task<void> listen(std::shared_ptr<Client> client);
+    Task<bool> flush(Client &client, std::vector<std::byte> &buffer);
+    bool tolerate(Client &client, std::size_t lag);
+    void disconnect(Client &client);
+    void check_lagging();
+
+    std::size_t parse(Client &client, std::span<std::byte> bytes);
+    void handle_message(Client &client, ClientMessage &&message);
+    void join(Client &client, String &&name);
+    const TurnFeed::Entry &publish(ServerMessage &&message);
+    const TurnFeed::Entry &publish_turn(Turn &&turn);
+    void start_recording();
+    void start_game();
+    Task<void> play();
+    void simulate(std::span<const PendingAction> pending);
+    void end_game();
+    void record_delivery();
+    void update_vacancies();
+};
+
+} // namespace SK
+
+#endif // __SK_GAME_ROOM_H__
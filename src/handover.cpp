@@ -0,0 +1,110 @@
+#include "handover.h"
+
+#include <algorithm>    // std::min
+#include <cstddef>
+#include <cstring>      // std::memcpy
+#include <stdexcept>
+#include <utility>      // std::move
+
+namespace SK {
+
+namespace {
+
+void send_frame(const UnixSocket &connection, std::span<const std::byte> payload, std::span<const int> descriptors) {
+    const Handover::FrameHeader header{static_cast<u32>(payload.size()), static_cast<u32>(descriptors.size())};
+    std::vector<std::byte> frame(sizeof(header) + payload.size());
+    std::memcpy(frame.data(), &header, sizeof(header));
+    if (!payload.empty())
+        std::memcpy(frame.data() + sizeof(header), payload.data(), payload.size());
+    connection.send_descriptors(frame, descriptors);
+}
+
+struct Frame {
+    std::vector<std::byte> payload;
+    std::vector<StreamSocket> sockets;
+};
+
+Frame receive_frame(const UnixSocket &connection) {
+    Handover::FrameHeader header{};
+    Frame frame{};
+    frame.sockets = connection.receive_descriptors(std::as_writable_bytes(std::span{&header, 1}));
+    if (frame.sockets.size() != header.descriptors)
+        throw std::runtime_error{"[receive_frame] The descriptors do not match the header."};
+
+    frame.payload.resize(header.length);
+    if (!frame.payload.empty() && !connection.receive_descriptors(frame.payload).empty())
+        throw std::runtime_error{"[receive_frame] Unexpected descriptors."};
+    return frame;
+}
+
+u32 read_count(const Frame &frame) {
+    u32 count = 0;
+    if (frame.payload.size() < sizeof(count))
+        throw std::runtime_error{"[take_over] The frame is too short."};
+    std::memcpy(&count, frame.payload.data(), sizeof(count));
+    return count;
+}
+
+} // anonymous namespace
+
+void hand_over(const UnixSocket &connection, std::span<StreamSocket* const> listeners, std::vector<GameRoom::Handover> &&rooms) {
+    std::vector<int> descriptors{};
+    for (const StreamSocket *listener : listeners)
+        descriptors.push_back(listener->native_handle());
+    const u32 room_count = static_cast<u32>(rooms.size());
+    send_frame(connection, std::as_bytes(std::span{&room_count, 1}), descriptors);
+
+    for (const GameRoom::Handover &room : rooms) {
+        const u32 client_count = static_cast<u32>(room.clients.size());
+        std::vector<std::byte> payload(sizeof(client_count));
+        std::memcpy(payload.data(), &client_count, sizeof(client_count));
+        payload.insert(payload.end(), room.checkpoint.begin(), room.checkpoint.end());
+
+        descriptors.clear();
+        for (const StreamSocket &client : room.clients)
+            descriptors.push_back(client.native_handle());
+
+        const std::span<const int> all{descriptors};
+        std::size_t sent = std::min(all.size(), UnixSocket::MAX_DESCRIPTORS);
+        send_frame(connection, payload, all.first(sent));
+        while (sent < all.size()) {
+            const std::size_t chunk = std::min(all.size() - sent, UnixSocket::MAX_DESCRIPTORS);
+            send_frame(connection, {}, all.subspan(sent, chunk));
+            sent += chunk;
+        }
+    }
+}
+
+std::optional<Takeover> take_over(const std::string &path) {
+    UnixSocket connection{};
+    try {
+        connection.connect(path);
+    } catch (const std::runtime_error&) {
+        // Nobody is listening there -- this is the first server.
+        return std::nullopt;
+    }
+
+    Takeover takeover{};
+    Frame first = receive_frame(connection);
+    takeover.listeners = std::move(first.sockets);
+
+    for (u32 room_count = read_count(first); room_count > 0; --room_count) {
+        Frame frame = receive_frame(connection);
+        const u32 client_count = read_count(frame);
+
+        GameRoom::Handover room{};
+        room.checkpoint.assign(frame.payload.begin() + sizeof(client_count), frame.payload.end());
+        room.clients = std::move(frame.sockets);
+        while (room.clients.size() < client_count) {
+            Frame rest = receive_frame(connection);
+            if (!rest.payload.empty() || rest.sockets.empty())
+                throw std::runtime_error{"[take_over] Expected the rest of the clients."};
+            for (StreamSocket &socket : rest.sockets)
+                room.clients.push_back(std::move(socket));
+        }
+        takeover.rooms.push_back(std::move(room));
+    }
+    return takeover;
+}
+
+} // namespace SK
@@ -0,0 +1,59 @@
+#ifndef __SK_HANDOVER_H__
+#define __SK_HANDOVER_H__
+
+#include <messages/common.h>
+#include <network/stream_socket.h>
+#include <network/unix_socket.h>
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "game_room.h"
+
+namespace SK {
+
+/*
+    A running server hands everything over to a new one -- to upgrade it,
+    say -- without a single client noticing. The running server listens
+    on a control socket; the new one, started with the same path, connects
+    to it, and the running one stops every room between two turns and
+    passes the new one its listening sockets, then the checkpoint and
+    the sockets of the clients of every room (see GameRoom::hand_over()).
+
+    Everything goes over the control connection in frames:
+
+        [FrameHeader] [length bytes]
+
+    with the descriptors attached to the header. The first frame holds
+    the number of rooms and carries the listening sockets. Every room
+    follows with a frame holding [u32 number of clients] [RoomCheckpoint],
+    and with as many frames of no bytes as it takes to carry the rest of
+    its clients, as a frame carries at most UnixSocket::MAX_DESCRIPTORS.
+    The integers are in the byte order of the host -- both ends are on it.
+*/
+namespace Handover {
+
+struct FrameHeader {
+    u32 length;
+    u32 descriptors;
+};
+
+} // namespace Handover
+
+/* What a new server takes over. */
+struct Takeover {
+    std::vector<StreamSocket> listeners;
+    std::vector<GameRoom::Handover> rooms;
+};
+
+/* Sends everything to the new server at the other end of the connection. */
+void hand_over(const UnixSocket &connection, std::span<StreamSocket* const> listeners, std::vector<GameRoom::Handover> &&rooms);
+
+/* Returns std::nullopt if there is no server to take over from at the path. */
+std::optional<Takeover> take_over(const std::string &path);
+
+} // namespace SK
+
+#endif // __SK_HANDOVER_H__
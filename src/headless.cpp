@@ -0,0 +1,238 @@
+#include "headless.h"
+#include "auxiliary.h"
+#include "board.h"
+#include "game_engine.h"
+#include "game_history.h"
+#include "input_trace.h"
+#include "player_table.h"
+#include "random.h"
+
+#include <messages/serializer.h>
+
+#include <algorithm>    // std::max, std::min
+#include <chrono>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>  // std::pair
+#include <vector>
+
+namespace SK {
+
+namespace {
+
+constexpr std::uint32_t ACTION_COUNT = static_cast<std::uint32_t>(PendingAction::MOVE_LEFT) + 1;
+
+} // anonymous namespace
+
+HeadlessReport run_headless(const ServerParameters &parameters, std::size_t games) {
+    const std::uint32_t seed = parameters.seed ? *parameters.seed : get_seed();
+    Random random{seed};
+    // The players get a generator of their own, so that they do not disturb the game's.
+    Random players{SK::rand(seed ^ 0x9e3779b9u)};
+
+    std::vector<PendingAction> actions(parameters.players_count, PendingAction::NONE);
+    HeadlessReport report{};
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::size_t game = 0; game < games; ++game) {
+        GameEngine engine{parameters, random};
+        report.events += engine.start().get<"events">().size();
+
+        while (!engine.finished()) {
+            for (auto &action : actions)
+                action = static_cast<PendingAction>(players() % ACTION_COUNT);
+            report.events += engine.next_turn(std::span<const PendingAction>{actions}).get<"events">().size();
+            ++report.turns;
+        }
+
+        ++report.games;
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    return report;
+}
+
+namespace {
+
+void mismatch(HeadlessReport &report, std::uint64_t turn) {
+    ++report.mismatches;
+    if (!report.first_mismatch)
+        report.first_mismatch = std::pair{report.games, turn};
+}
+
+/* Whether the message comes out as recorded -- counts it as a mismatch otherwise. */
+void check(const ServerMessage &message, u32 expected, HeadlessReport &report, std::uint64_t turn) {
+    std::vector<std::byte> bytes{};
+    VectorInserter inserter{bytes};
+    Serializer<ServerMessage>::serialize(message, inserter);
+    if (InputTrace::digest(std::span<const std::byte>{bytes}) != expected)
+        mismatch(report, turn);
+}
+
+/* Whether the events of the turn add up to the state of the engine -- counts it as a mismatch otherwise. */
+void follow(GameHistory &history, const Turn &turn, const GameEngine &engine, HeadlessReport &report) {
+    history.record(turn);
+    if (!(history.latest() == engine.state()))
+        mismatch(report, turn.get<"turn">());
+}
+
+} // anonymous namespace
+
+HeadlessReport replay_input_trace(const std::string &path) {
+    InputTraceReader trace{path};
+    HeadlessReport report{};
+    std::vector<PendingAction> actions{};
+    // A few states along the way, which the history has to rebuild at the end of the game.
+    std::vector<GameHistory::TurnInfo> samples{};
+
+    const auto begin = std::chrono::steady_clock::now();
+    while (const auto game = trace.next_game()) {
+        const ServerParameters &parameters = game->parameters;
+        Random random{game->random_state};
+        GameEngine engine{parameters, random};
+        GameHistory history{parameters.players_count, parameters.size_x, parameters.size_y, parameters.bomb_timer};
+        actions.assign(parameters.players_count, PendingAction::NONE);
+        samples.clear();
+        const u16 sample_interval = static_cast<u16>(std::max(game->turns / 4, 1));
+
+        Turn start = engine.start();
+        report.events += start.get<"events">().size();
+        follow(history, start, engine, report);
+        check(ServerMessage{std::move(start)}, trace.digest(), report, 0);
+
+        // The trace tells how many turns to play -- the engine ending sooner or later is a mismatch of its own.
+        for (u16 recorded = 0; recorded < game->turns; ++recorded) {
+            trace.actions(std::span<PendingAction>{actions});
+            const u32 expected = trace.digest();
+            if (engine.finished())
+                continue;
+            Turn turn = engine.next_turn(std::span<const PendingAction>{actions});
+            report.events += turn.get<"events">().size();
+            ++report.turns;
+            follow(history, turn, engine, report);
+            if (engine.current_turn() % sample_interval == 0)
+                samples.push_back(history.latest());
+            check(ServerMessage{std::move(turn)}, expected, report, engine.current_turn());
+        }
+        for (const GameHistory::TurnInfo &sample : samples)
+            if (!(history.state_at(sample.turn) == sample))
+                mismatch(report, sample.turn);
+        if (engine.current_turn() != game->turns || !engine.finished())
+            mismatch(report, std::uint64_t{engine.current_turn()} + 1);
+
+        check(ServerMessage{engine.end()}, trace.digest(), report, std::uint64_t{engine.current_turn()} + 1);
+        ++report.games;
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    return report;
+}
+
+namespace {
+
+/* Mostly next to a multiple of 64 -- a word boundary, and a band boundary for the lines. */
+std::size_t draw_index(Random &random, std::size_t size) {
+    const std::uint32_t value = random();
+    if (value % 4 == 0)
+        return value / 4 % size;
+    const std::size_t edge = value / 4 % (size / BitMatrix::WORD_BITS + 1) * BitMatrix::WORD_BITS;
+    const std::size_t index = edge + value / 4 % 3;
+    return index ? std::min(index - 1, size - 1) : 0;
+}
+
+void mismatch(BoardCheckReport &report, const std::string &what) {
+    ++report.mismatches;
+    if (report.first_mismatch.empty())
+        report.first_mismatch = what;
+}
+
+/* Compares everything the matrices tell -- after every operation, as the matrices are small. */
+void compare(const BitMatrix &dense, const BitMatrix &tiled, std::size_t lines, std::size_t line_length,
+             Random &random, BoardCheckReport &report, const std::string &operation) {
+    if (dense.popcount() != tiled.popcount())
+        mismatch(report, operation + ": popcount");
+
+    std::vector<std::pair<std::size_t, std::size_t>> dense_bits{}, tiled_bits{};
+    dense.for_each([&](std::size_t line, std::size_t i) { dense_bits.emplace_back(line, i); });
+    tiled.for_each([&](std::size_t line, std::size_t i) { tiled_bits.emplace_back(line, i); });
+    if (dense_bits != tiled_bits)
+        mismatch(report, operation + ": for_each");
+
+    const std::size_t line = draw_index(random, lines);
+    std::size_t from = draw_index(random, line_length);
+    std::size_t to = draw_index(random, line_length);
+    if (from > to)
+        std::swap(from, to);
+    const std::string range = " in line " + std::to_string(line) + ", [" + std::to_string(from) + ", " + std::to_string(to) + "]";
+
+    if (dense.find_first(line, from, to) != tiled.find_first(line, from, to))
+        mismatch(report, operation + ": find_first" + range);
+    if (dense.find_last(line, from, to) != tiled.find_last(line, from, to))
+        mismatch(report, operation + ": find_last" + range);
+
+    std::vector<std::size_t> dense_in{}, tiled_in{};
+    dense.for_each_in(line, from, to, [&](std::size_t i) { dense_in.push_back(i); });
+    tiled.for_each_in(line, from, to, [&](std::size_t i) { tiled_in.push_back(i); });
+    if (dense_in != tiled_in)
+        mismatch(report, operation + ": for_each_in" + range);
+}
+
+} // anonymous namespace
+
+BoardCheckReport check_board(std::uint32_t seed) {
+    // A single line or word, lines ending right at or just past a word, and bands cut short.
+    constexpr std::pair<std::size_t, std::size_t> shapes[] = {
+        {1, 1}, {1, 64}, {3, 65}, {64, 64}, {65, 127}, {129, 200}, {200, 129}, {70, 4097}
+    };
+    constexpr std::size_t OPERATIONS = 4000;
+
+    Random random{seed};
+    BoardCheckReport report{};
+    for (const auto &[lines, line_length] : shapes) {
+        BitMatrix dense{lines, line_length};
+        BitMatrix tiled{lines, line_length, 0};
+        if (dense.is_tiled() || !tiled.is_tiled()) {
+            mismatch(report, "the modes of a " + std::to_string(lines) + "x" + std::to_string(line_length) + " matrix");
+            continue;
+        }
+
+        for (std::size_t n = 0; n < OPERATIONS; ++n) {
+            const std::size_t line = draw_index(random, lines);
+            const std::size_t i = draw_index(random, line_length);
+            // Setting twice as often as resetting, so that the matrices fill up between the clears.
+            std::string operation{};
+            const std::uint32_t choice = random() % 64;
+            if (choice == 0) {
+                dense.clear();
+                tiled.clear();
+                operation = "clear";
+            } else if (choice % 3) {
+                dense.set(line, i);
+                tiled.set(line, i);
+                operation = "set";
+            } else {
+                dense.reset(line, i);
+                tiled.reset(line, i);
+                operation = "reset";
+            }
+            operation = std::to_string(lines) + "x" + std::to_string(line_length) + ", operation " + std::to_string(n)
+                + " (" + operation + " " + std::to_string(line) + ", " + std::to_string(i) + ")";
+
+            if (dense.test(line, i) != tiled.test(line, i))
+                mismatch(report, operation + ": test");
+            compare(dense, tiled, lines, line_length, random, report, operation);
+            ++report.operations;
+        }
+        // Every tile emptied has gone back to the pool.
+        dense.clear();
+        for (std::size_t line = 0; line < lines; ++line)
+            for (std::size_t i = 0; i < line_length; ++i)
+                tiled.reset(line, i);
+        if (tiled.tile_count() || tiled.popcount())
+            mismatch(report, std::to_string(lines) + "x" + std::to_string(line_length) + ": tiles left after resetting every bit");
+    }
+    return report;
+}
+
+} // namespace SK
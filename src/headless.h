@@ -0,0 +1,77 @@
+#ifndef __SK_HEADLESS_H__
+#define __SK_HEADLESS_H__
+
+#include <messages/common.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>  // std::pair
+
+#include "server_state.h"
+
+namespace SK {
+
+/* The outcome of a headless run. */
+struct HeadlessReport {
+    std::uint64_t games = 0;
+    std::uint64_t turns = 0;
+    std::uint64_t events = 0;
+    double seconds = 0;
+
+    // Replaying an input trace -- the messages which have come out different from the recorded ones,
+    // or whose events do not add up to the state of the engine.
+    std::uint64_t mismatches = 0;
+    // The game and the turn of the first of them -- GameEnded counts as the turn after the last one.
+    std::optional<std::pair<std::uint64_t, std::uint64_t>> first_mismatch = std::nullopt;
+
+    double turns_per_second() const {
+        return seconds > 0 ? static_cast<double>(turns) / seconds : 0;
+    }
+
+    double events_per_second() const {
+        return seconds > 0 ? static_cast<double>(events) / seconds : 0;
+    }
+};
+
+/*
+    Plays the given number of games back to back on the engine alone --
+    no sockets, no waiting for the turns to pass. Every player is synthetic
+    and draws a random action (possibly none) each turn from a generator
+    seeded through SK::rand, so a run is reproducible given a seed.
+*/
+HeadlessReport run_headless(const ServerParameters &parameters, std::size_t games);
+
+/*
+    Plays the games of an input trace (see InputTraceWriter) again, as fast
+    as the engine goes, and checks that every message comes out the same --
+    byte for byte, up to the digest. The time includes the serialisation,
+    which the comparison needs, just as the server needs it to send a turn.
+
+    The events are also followed in a GameHistory, as a client follows them:
+    after every turn, the state they describe has to be the engine's, and
+    at the end of a game, the history has to rebuild a few earlier states.
+*/
+HeadlessReport replay_input_trace(const std::string &path);
+
+/* The outcome of check_board(). */
+struct BoardCheckReport {
+    std::uint64_t operations = 0;
+    std::uint64_t mismatches = 0;
+    // What the first of them has come out of -- empty if there is none.
+    std::string first_mismatch{};
+};
+
+/*
+    Runs the same random operations on a dense and a tiled BitMatrix of
+    a few shapes and compares every query. The tiled mode only kicks in
+    for boards far too large to play in a test, so this is what covers it.
+    The bits are drawn mostly around the edges of the words and the bands
+    of tiles, where the tiles get allocated and released.
+*/
+BoardCheckReport check_board(std::uint32_t seed);
+
+} // namespace SK
+
+#endif // __SK_HEADLESS_H__
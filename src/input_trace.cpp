@@ -0,0 +1,127 @@
+#include "input_trace.h"
+
+#include <cstddef>      // offsetof
+#include <cstring>      // std::memcpy
+#include <iterator>     // std::istreambuf_iterator
+#include <stdexcept>
+
+namespace SK {
+
+InputTraceWriter::InputTraceWriter(const std::string &path)
+: file{path, std::ios::binary | std::ios::app} {
+    if (!file)
+        throw std::runtime_error{"[InputTraceWriter: InputTraceWriter] Cannot open " + path + "."};
+}
+
+void InputTraceWriter::append(const void *data, std::size_t size) {
+    const auto *bytes = static_cast<const std::byte*>(data);
+    game.insert(game.end(), bytes, bytes + size);
+}
+
+void InputTraceWriter::begin(const ServerParameters &parameters, u32 random_state, std::span<const std::byte> start) {
+    InputTrace::GameHeader header{};
+    header.magic = InputTrace::MAGIC;
+    header.random_state = random_state;
+    header.size_x = parameters.size_x;
+    header.size_y = parameters.size_y;
+    header.game_length = parameters.game_length;
+    header.explosion_radius = parameters.explosion_radius;
+    header.bomb_timer = parameters.bomb_timer;
+    header.initial_blocks = parameters.initial_blocks;
+    header.players_count = parameters.players_count;
+    players_count = parameters.players_count;
+    turns = 0;
+
+    game.clear();
+    append(&header, sizeof(header));
+    const u32 digest = InputTrace::digest(start);
+    append(&digest, sizeof(digest));
+}
+
+void InputTraceWriter::turn(std::span<const PendingAction> actions, std::span<const std::byte> bytes) {
+    for (std::size_t id = 0; id < players_count; id += 2) {
+        const u8 low = to_underlying(actions[id]);
+        const u8 high = id + 1 < players_count ? to_underlying(actions[id + 1]) : u8{0};
+        const u8 packed = static_cast<u8>(low | high << 4);
+        append(&packed, sizeof(packed));
+    }
+    const u32 digest = InputTrace::digest(bytes);
+    append(&digest, sizeof(digest));
+    ++turns;
+}
+
+void InputTraceWriter::end(std::span<const std::byte> bytes) {
+    const u32 digest = InputTrace::digest(bytes);
+    append(&digest, sizeof(digest));
+    std::memcpy(game.data() + offsetof(InputTrace::GameHeader, turns), &turns, sizeof(turns));
+
+    file.write(reinterpret_cast<const char*>(game.data()), static_cast<std::streamsize>(game.size()));
+    file.flush();
+    game.clear();
+    if (!file)
+        throw std::runtime_error{"[InputTraceWriter: end] The game could not be written."};
+}
+
+InputTraceReader::InputTraceReader(const std::string &path) {
+    std::ifstream file{path, std::ios::binary};
+    if (!file)
+        throw std::runtime_error{"[InputTraceReader: InputTraceReader] Cannot open " + path + "."};
+
+    const std::vector<char> bytes{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    contents.resize(bytes.size());
+    std::memcpy(contents.data(), bytes.data(), bytes.size());
+}
+
+void InputTraceReader::read(void *data, std::size_t size) {
+    if (contents.size() - position < size)
+        throw std::runtime_error{"[InputTraceReader: read] The trace is truncated."};
+    std::memcpy(data, contents.data() + position, size);
+    position += size;
+}
+
+std::optional<InputTraceReader::Game> InputTraceReader::next_game() {
+    if (position == contents.size())
+        return std::nullopt;
+
+    InputTrace::GameHeader header{};
+    read(&header, sizeof(header));
+    if (header.magic != InputTrace::MAGIC)
+        throw std::runtime_error{"[InputTraceReader: next_game] Not an input trace, or a different version of it."};
+
+    Game game{};
+    game.random_state = header.random_state;
+    game.turns = header.turns;
+    game.parameters.players_count = header.players_count;
+    game.parameters.size_x = header.size_x;
+    game.parameters.size_y = header.size_y;
+    game.parameters.game_length = header.game_length;
+    game.parameters.explosion_radius = header.explosion_radius;
+    game.parameters.bomb_timer = header.bomb_timer;
+    game.parameters.initial_blocks = header.initial_blocks;
+    players_count = header.players_count;
+    return game;
+}
+
+u32 InputTraceReader::digest() {
+    u32 result = 0;
+    read(&result, sizeof(result));
+    return result;
+}
+
+void InputTraceReader::actions(std::span<PendingAction> actions) {
+    const auto unpack = [](u8 value) {
+        if (value > to_underlying(PendingAction::MOVE_LEFT))
+            throw std::runtime_error{"[InputTraceReader: actions] Not an action."};
+        return static_cast<PendingAction>(value);
+    };
+
+    for (std::size_t id = 0; id < players_count; id += 2) {
+        u8 packed = 0;
+        read(&packed, sizeof(packed));
+        actions[id] = unpack(static_cast<u8>(packed & 0xf));
+        if (id + 1 < players_count)
+            actions[id + 1] = unpack(static_cast<u8>(packed >> 4));
+    }
+}
+
+} // namespace SK
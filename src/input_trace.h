@@ -0,0 +1,117 @@
+#ifndef __SK_INPUT_TRACE_H__
+#define __SK_INPUT_TRACE_H__
+
+#include <messages/common.h>
+
+#include <cstddef>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "player_table.h"
+#include "server_state.h"
+
+namespace SK {
+
+/*
+    An input trace holds what determines a game: the parameters the engine
+    depends on, the state of the generator when the game starts and the action
+    of every player in every turn. Given those, the engine plays the very same
+    game again -- which can be checked, as the trace also holds a digest
+    of every message the game has produced.
+
+    A trace is a sequence of games, each of them:
+
+        [GameHeader] [digest of the turn 0] ([actions] [digest of the turn])... [digest of GameEnded]
+
+    where the actions of a turn take half a byte per player. The header
+    tells how many turns there are, so that a replay which goes on longer
+    or ends sooner is caught too. The integers are in the byte order of the host which has written the trace.
+*/
+namespace InputTrace {
+
+constexpr u64 MAGIC = 0x3230545049524b53;   // "SKRIPT02"
+
+struct GameHeader {
+    u64 magic;
+    u32 random_state;
+    u16 size_x;
+    u16 size_y;
+    u16 game_length;
+    u16 explosion_radius;
+    u16 bomb_timer;
+    u16 initial_blocks;
+    u16 turns;          // filled in once the game has ended
+    u8 players_count;
+    u8 reserved[5];
+};
+
+static_assert(sizeof(GameHeader) == 32, "The header is written as it is, it must not have any padding.");
+
+/* FNV-1a -- the trace only has to tell whether the bytes have changed. */
+inline u32 digest(std::span<const std::byte> bytes) {
+    u32 hash = 2166136261u;
+    for (const std::byte byte : bytes) {
+        hash ^= static_cast<u32>(byte);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+} // namespace InputTrace
+
+/*
+    InputTraceWriter -- appends the games of a room to a trace. A game
+    is gathered in memory and written out at once, when it ends, so
+    a trace only ever holds complete games.
+*/
+class InputTraceWriter {
+private:
+    std::ofstream file;
+    std::vector<std::byte> game{};
+    u8 players_count = 0;
+    u16 turns = 0;
+
+public:
+    explicit InputTraceWriter(const std::string &path);
+
+    /* The generator's state has to be taken before the engine is constructed. */
+    void begin(const ServerParameters &parameters, u32 random_state, std::span<const std::byte> start);
+    void turn(std::span<const PendingAction> actions, std::span<const std::byte> bytes);
+    void end(std::span<const std::byte> bytes);
+
+private:
+    void append(const void *data, std::size_t size);
+};
+
+/* InputTraceReader -- reads a trace back, game by game. */
+class InputTraceReader {
+public:
+    struct Game {
+        ServerParameters parameters;
+        u32 random_state;
+        u16 turns;
+    };
+
+private:
+    std::vector<std::byte> contents{};
+    std::size_t position = 0;
+    u8 players_count = 0;
+
+public:
+    explicit InputTraceReader(const std::string &path);
+
+    /* Returns std::nullopt once there are no more games. */
+    std::optional<Game> next_game();
+    u32 digest();
+    void actions(std::span<PendingAction> actions);
+
+private:
+    void read(void *data, std::size_t size);
+};
+
+} // namespace SK
+
+#endif // __SK_INPUT_TRACE_H__
@@ -0,0 +1,331 @@
+/*
+ * robots-loadgen -- a load generator for robots-server.
+ *
+ * It opens the requested number of connections to the server: players
+ * join the lobby as soon as they are greeted and then send a random action
+ * every turn, observers only listen. All of them are driven by a single
+ * EventLoop, so thousands of connections cost a single thread.
+ *
+ * The delivery latency of a turn is measured against the schedule of
+ * the game: the n-th turn is due turn_duration * n after the start. Every
+ * client takes the earliest turn of a game it has seen as the reference
+ * point, so the latency of a turn is how much later than that it has
+ * arrived. Alongside, the number of connections the server keeps open
+ * is sampled every second.
+ */
+
+#include <messages/client_messages.h>
+#include <messages/serializer.h>
+#include <messages/server_messages.h>
+#include <network/async_socket.h>
+#include <network/event_loop.h>
+#include <network/socket.h>
+#include <network/unix_socket.h>
+#include <utilities/miscellaneous.h>
+#include <utilities/task.h>
+
+#include "auxiliary.h"
+#include "random.h"
+
+#include <getopt.h> // getopt_long
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>  // EXIT_FAILURE
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <iostream>
+
+using namespace SK;
+
+namespace {
+
+using Clock = EventLoop::Clock;
+
+struct Options {
+    std::string host = "localhost";
+    u16 port = 0;
+    std::string unix_path{};    // connects over a Unix domain socket instead, if set
+    std::size_t players = 0;
+    std::size_t observers = 0;
+    u64 turn_duration = 0;  // in ms
+    u64 duration = 10;      // in s
+    u32 seed = get_seed();
+};
+
+struct Statistics {
+    std::vector<std::int64_t> latencies{};  // in µs
+    std::uint64_t turns = 0;
+    std::size_t connected = 0;
+    std::size_t running = 0;
+    std::size_t fewest_connected = std::numeric_limits<std::size_t>::max();
+};
+
+struct Client {
+    AsyncSocket socket;
+    const bool player;
+    const std::size_t index;
+    bool connected = true;
+
+    // The offsets of the turns of the current game from the schedule, in µs.
+    std::vector<std::int64_t> offsets{};
+
+    Client(AsyncSocket &&socket_, bool player_, std::size_t index_)
+    : socket{std::move(socket_)}
+    , player{player_}
+    , index{index_} {}
+};
+
+Options parse_options(int argc, char *argv[]) {
+    const option long_options[] = {
+        {"address",       required_argument, nullptr, 'a'},
+        {"unix-socket",   required_argument, nullptr, 'u'},
+        {"port",          required_argument, nullptr, 'p'},
+        {"players",       required_argument, nullptr, 'c'},
+        {"observers",     required_argument, nullptr, 'o'},
+        {"turn-duration", required_argument, nullptr, 'd'},
+        {"time",          required_argument, nullptr, 't'},
+        {"seed",          required_argument, nullptr, 's'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    Options options{};
+    int option;
+    while ((option = getopt_long(argc, argv, "a:u:p:c:o:d:t:s:", long_options, nullptr)) != -1) {
+        switch (option) {
+            case 'a': options.host = optarg; break;
+            case 'u': options.unix_path = optarg; break;
+            case 'p': options.port = parse_number<u16>(optarg, 'p'); break;
+            case 'c': options.players = parse_number<std::size_t>(optarg, 'c'); break;
+            case 'o': options.observers = parse_number<std::size_t>(optarg, 'o'); break;
+            case 'd': options.turn_duration = parse_number<u64>(optarg, 'd'); break;
+            case 't': options.duration = parse_number<u64>(optarg, 't'); break;
+            case 's': options.seed = parse_number<u32>(optarg, 's'); break;
+            default:
+                throw std::invalid_argument{"[parse_options] Unknown option."};
+        }
+    }
+
+    if ((!options.port && options.unix_path.empty()) || !options.turn_duration)
+        throw std::invalid_argument{"[parse_options] Both -p (or -u) and -d are required."};
+    return options;
+}
+
+/* Thousands of connections do not fit in the default limit of descriptors. */
+void raise_descriptor_limit() {
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+StreamSocket connect(const Options &options) {
+    if (!options.unix_path.empty()) {
+        UnixSocket socket{};
+        socket.connect(options.unix_path);
+        return socket;
+    }
+
+    TCPSocket socket{};
+    socket.connect(options.host, options.port);
+    return socket;
+}
+
+ClientMessage random_action(Random &random) {
+    switch (random() % 6) {
+        case 0: return PlaceBomb{};
+        case 1: return PlaceBlock{};
+        default: break;
+    }
+
+    Move move{};
+    switch (random() % 4) {
+        case 0: move.get<"direction">() = DirectionMessage::Up{}; break;
+        case 1: move.get<"direction">() = DirectionMessage::Right{}; break;
+        case 2: move.get<"direction">() = DirectionMessage::Down{}; break;
+        default: move.get<"direction">() = DirectionMessage::Left{}; break;
+    }
+    return move;
+}
+
+Task<bool> send(Client &client, ClientMessage &&message) {
+    std::vector<std::byte> bytes{};
+    VectorInserter inserter{bytes};
+    Serializer<ClientMessage>::serialize(message, inserter);
+    const bool sent = co_await client.socket.write_all(std::span<std::byte>{bytes});
+    co_return sent;
+}
+
+/* The lobby is left empty after every game -- a player joins it again then, as on Hello. */
+Task<bool> join(Client &client) {
+    Join message{};
+    message.get<"name">() = String{"loadgen-" + std::to_string(client.index)};
+    const bool sent = co_await send(client, std::move(message));
+    co_return sent;
+}
+
+/* The latencies of a game are known once its earliest turn is. */
+void settle(Client &client, Statistics &statistics) {
+    if (client.offsets.empty())
+        return;
+    const std::int64_t reference = *std::min_element(client.offsets.begin(), client.offsets.end());
+    for (const std::int64_t offset : client.offsets)
+        statistics.latencies.push_back(offset - reference);
+    client.offsets.clear();
+}
+
+Task<void> drive(std::shared_ptr<Client> client, Statistics &statistics, const Options &options, Random &random, Clock::time_point end_time) {
+    std::vector<std::byte> buffer(4096);
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    auto game_start = Clock::now();
+    bool time_up = false;
+
+    try {
+        while (client->connected) {
+            if (end == buffer.size()) {
+                if (begin == 0)
+                    buffer.resize(buffer.size() * 2);
+                std::copy(buffer.begin() + static_cast<std::ptrdiff_t>(begin), buffer.begin() + static_cast<std::ptrdiff_t>(end), buffer.begin());
+                end -= begin;
+                begin = 0;
+            }
+
+            // The time being up ends the read on its own -- only a stuck write has to be cancelled.
+            const std::optional<std::size_t> received = co_await client->socket.read_some_until(std::span<std::byte>{buffer}.subspan(end), end_time);
+            time_up = !received;
+            if (!received || !*received)
+                break;
+            end += *received;
+            const auto now = Clock::now();
+
+            while (begin < end) {
+                SimpleConsumer consumer{std::span<std::byte>{buffer}.subspan(begin, end - begin)};
+                ServerMessage message{};
+                try {
+                    message = Serializer<ServerMessage>::deserialize(consumer);
+                } catch (const std::out_of_range&) {
+                    break;  // Only a part of the message has arrived so far.
+                }
+                begin += consumer.index;
+
+                if (std::holds_alternative<Hello>(message) && client->player) {
+                    const bool sent = co_await join(*client);
+                    client->connected = client->connected && sent;
+                } else if (const Turn *turn = std::get_if<Turn>(&message)) {
+                    const u16 number = turn->get<"turn">();
+                    if (number == 0)
+                        game_start = now;
+                    const auto due = game_start + std::chrono::milliseconds{options.turn_duration * number};
+                    client->offsets.push_back(std::chrono::duration_cast<std::chrono::microseconds>(now - due).count());
+                    ++statistics.turns;
+
+                    if (client->player) {
+                        const bool sent = co_await send(*client, random_action(random));
+                        client->connected = client->connected && sent;
+                    }
+                } else if (std::holds_alternative<GameEnded>(message)) {
+                    settle(*client, statistics);
+                    if (client->player) {
+                        const bool sent = co_await join(*client);
+                        client->connected = client->connected && sent;
+                    }
+                }
+            }
+        }
+    } catch (const std::exception&) {
+        // The server has sent something it should not have -- or has gone.
+    }
+
+    settle(*client, statistics);
+    client->connected = false;
+    // Only the connections closed before the time is up count as dropped by the server.
+    if (!time_up)
+        --statistics.connected;
+    --statistics.running;
+}
+
+/* Samples the number of open connections until the time is up, then winds everything down. */
+Task<void> supervise(EventLoop &loop, std::vector<std::shared_ptr<Client>> &clients, Statistics &statistics, Clock::time_point deadline) {
+    auto next = Clock::now();
+
+    while (next < deadline) {
+        next = std::min(next + std::chrono::seconds{1}, deadline);
+        co_await loop.sleep_until(next);
+        statistics.fewest_connected = std::min(statistics.fewest_connected, statistics.connected);
+    }
+
+    for (auto &client : clients) {
+        client->connected = false;
+        client->socket.cancel();
+    }
+    while (statistics.running)
+        co_await loop.sleep_until(Clock::now() + std::chrono::milliseconds{10});
+    loop.stop();
+}
+
+std::int64_t percentile(const std::vector<std::int64_t> &sorted, double fraction) {
+    if (sorted.empty())
+        return 0;
+    const auto index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1));
+    return sorted[index];
+}
+
+void report(Statistics &statistics, const Options &options) {
+    auto &latencies = statistics.latencies;
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << "connections: " << options.players + options.observers
+              << " (" << options.players << " players, " << options.observers << " observers)\n"
+              << "kept open by the server: at least " << statistics.fewest_connected << '\n'
+              << "turns received: " << statistics.turns << '\n'
+              << "delivery latency [us]: p50 " << percentile(latencies, 0.5)
+              << ", p99 " << percentile(latencies, 0.99)
+              << ", p999 " << percentile(latencies, 0.999)
+              << ", max " << (latencies.empty() ? 0 : latencies.back()) << '\n';
+}
+
+void run(const Options &options) {
+    raise_descriptor_limit();
+
+    EventLoop loop{};
+    Random random{options.seed};
+    Statistics statistics{};
+    std::vector<std::shared_ptr<Client>> clients{};
+
+    const std::size_t total = options.players + options.observers;
+    for (std::size_t i = 0; i < total; ++i)
+        clients.push_back(std::make_shared<Client>(AsyncSocket{connect(options), loop}, i < options.players, i));
+
+    const auto end_time = Clock::now() + std::chrono::seconds{options.duration};
+    statistics.connected = statistics.running = clients.size();
+    for (auto &client : clients)
+        spawn(drive(client, statistics, options, random, end_time));
+    spawn(supervise(loop, clients, statistics, end_time));
+
+    loop.run();
+    report(statistics, options);
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+    try {
+        run(parse_options(argc, argv));
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
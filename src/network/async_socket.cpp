@@ -0,0 +1,104 @@
+#include <network/async_socket.h>
+
+namespace SK {
+
+AsyncSocket::AsyncSocket(StreamSocket &&socket_, EventLoop &event_loop_)
+: socket{std::move(socket_)}
+, event_loop{&event_loop_}
+{
+    socket.set_socket_blocking(false);
+}
+
+AsyncSocket::~AsyncSocket() {
+    if (socket.native_handle() != -1)
+        cancel();
+}
+
+/* A peer which never stops sending must not keep the loop to itself -- every few reads, the others get their turn. */
+Task<void> AsyncSocket::yield_if_busy() {
+    if (++immediate_reads <= MAX_IMMEDIATE_READS)
+        co_return;
+    immediate_reads = 0;
+    co_await event_loop->schedule();
+}
+
+/* Reads straight away if the data is already there -- only waits for the loop otherwise. */
+std::optional<std::size_t> AsyncSocket::try_read(std::span<std::byte> span) {
+    const std::optional<std::size_t> received = socket.try_receive(span);
+    ++io.receives;
+    io.bytes_in += received.value_or(0);
+    return received;
+}
+
+Task<std::size_t> AsyncSocket::read_some(std::span<std::byte> span) {
+    co_await yield_if_busy();
+    while (true) {
+        if (const auto received = try_read(span))
+            co_return *received;
+        immediate_reads = 0;
+        // Kept out of the condition -- GCC 12 miscompiles a co_await negated inside an if.
+        const bool ready = co_await event_loop->readable(socket.native_handle());
+        if (!ready)
+            co_return 0;
+    }
+}
+
+Task<std::optional<std::size_t>> AsyncSocket::read_some_until(std::span<std::byte> span, EventLoop::Clock::time_point deadline) {
+    co_await yield_if_busy();
+    while (true) {
+        if (const auto received = try_read(span))
+            co_return received;
+        immediate_reads = 0;
+        const EventLoop::Readiness readiness = co_await event_loop->readable_until(socket.native_handle(), deadline);
+        if (readiness == EventLoop::Readiness::TIMED_OUT)
+            co_return std::nullopt;
+        if (readiness == EventLoop::Readiness::CANCELLED)
+            co_return 0;
+    }
+}
+
+Task<bool> AsyncSocket::write_all(std::span<std::byte> span) {
+    while (!span.empty()) {
+        const std::size_t sent = socket.send_some(span);
+        ++io.sends;
+        io.bytes_out += sent;
+        io.short_writes += sent < span.size();
+        io.would_block += sent == 0;
+        span = span.subspan(sent);
+        if (span.empty())
+            break;
+        const bool ready = co_await event_loop->writable(socket.native_handle());
+        if (!ready)
+            co_return false;
+    }
+    co_return true;
+}
+
+Task<bool> AsyncSocket::write_file(int file_fd, std::uint64_t offset, std::size_t count) {
+    while (count) {
+        const std::size_t sent = socket.send_file_some(file_fd, offset, count);
+        ++io.sends;
+        io.bytes_out += sent;
+        io.short_writes += sent < count;
+        io.would_block += sent == 0;
+        offset += sent;
+        count -= sent;
+        if (!count)
+            break;
+        const bool ready = co_await event_loop->writable(socket.native_handle());
+        if (!ready)
+            co_return false;
+    }
+    co_return true;
+}
+
+void AsyncSocket::cancel() {
+    event_loop->cancel(socket.native_handle());
+}
+
+StreamSocket AsyncSocket::release() {
+    cancel();
+    return std::move(socket);
+}
+
+} // namespace SK
@@ -0,0 +1,244 @@
+#include <network/event_loop.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>  // std::exchange
+
+namespace SK {
+
+EventLoop::EventLoop() {
+    epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1)
+        throw std::runtime_error{strerror(errno)};
+
+    wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd == -1) {
+        ::close(epoll_fd);
+        throw std::runtime_error{strerror(errno)};
+    }
+
+    // The steady clock is CLOCK_MONOTONIC on Linux.
+    timer_fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd == -1) {
+        ::close(wake_fd);
+        ::close(epoll_fd);
+        throw std::runtime_error{strerror(errno)};
+    }
+
+    for (const int fd : {wake_fd, timer_fd}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+            ::close(timer_fd);
+            ::close(wake_fd);
+            ::close(epoll_fd);
+            throw std::runtime_error{strerror(errno)};
+        }
+    }
+}
+
+EventLoop::~EventLoop() {
+    ::close(timer_fd);
+    ::close(wake_fd);
+    ::close(epoll_fd);
+}
+
+void EventLoop::watch(int fd, Interest interest, Waiter &waiter) {
+    Watch &entry = watches[fd];
+    if (interest == Interest::READ)
+        entry.reader = &waiter;
+    else
+        entry.writer = &waiter;
+    update(fd, entry);
+}
+
+void EventLoop::expire(int fd, Interest interest, Waiter &waiter, Clock::time_point deadline) {
+    waiter.deadline = next_deadline++;
+    deadlines.emplace(waiter.deadline, &waiter);
+    timers.push(Timer{deadline, waiter.handle, waiter.deadline, fd, interest});
+}
+
+/* The waiter is about to be resumed -- its deadline, if any, does not matter anymore. */
+std::coroutine_handle<> EventLoop::release(Waiter &waiter) {
+    if (waiter.deadline)
+        deadlines.erase(std::exchange(waiter.deadline, 0));
+    return waiter.handle;
+}
+
+void EventLoop::update(int fd, Watch &entry) {
+    const unsigned desired = (entry.reader ? EPOLLIN : 0u) | (entry.writer ? EPOLLOUT : 0u);
+    if (desired == entry.registered)
+        return;
+
+    epoll_event event{};
+    event.events = desired;
+    event.data.fd = fd;
+
+    int operation = EPOLL_CTL_MOD;
+    if (!entry.registered)
+        operation = EPOLL_CTL_ADD;
+    else if (!desired)
+        operation = EPOLL_CTL_DEL;
+
+    if (::epoll_ctl(epoll_fd, operation, fd, &event) == -1)
+        throw std::runtime_error{strerror(errno)};
+    entry.registered = desired;
+}
+
+void EventLoop::cancel(int fd) {
+    auto it = watches.find(fd);
+    if (it == watches.end())
+        return;
+
+    for (Waiter *waiter : {it->second.reader, it->second.writer}) {
+        if (waiter) {
+            waiter->cancelled = true;
+            post(release(*waiter));
+        }
+    }
+
+    if (it->second.registered)
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    watches.erase(it);
+}
+
+void EventLoop::post(std::coroutine_handle<> handle) {
+    /* lock */ {
+        const std::lock_guard<std::mutex> lock{posted_mutex};
+        posted.push_back(handle);
+    }
+    wake();
+}
+
+void EventLoop::wake() {
+    const std::uint64_t value = 1;
+    // If the counter is about to overflow, the loop has been woken up anyway.
+    [[maybe_unused]] auto result = ::write(wake_fd, &value, sizeof(value));
+}
+
+void EventLoop::resume_posted() {
+    std::vector<std::coroutine_handle<>> handles{};
+    /* lock */ {
+        const std::lock_guard<std::mutex> lock{posted_mutex};
+        handles.swap(posted);
+    }
+    for (auto handle : handles)
+        handle.resume();
+}
+
+void EventLoop::resume_expired() {
+    const auto now = Clock::now();
+    while (!timers.empty() && timers.top().deadline <= now) {
+        const Timer timer = timers.top();
+        timers.pop();
+
+        if (timer.id) {
+            const auto it = deadlines.find(timer.id);
+            // The descriptor has become ready in time.
+            if (it == deadlines.end())
+                continue;
+            Waiter &waiter = *it->second;
+            deadlines.erase(it);
+            waiter.deadline = 0;
+            waiter.timed_out = true;
+
+            auto watch_it = watches.find(timer.fd);
+            if (watch_it != watches.end()) {
+                Watch &entry = watch_it->second;
+                (timer.interest == Interest::READ ? entry.reader : entry.writer) = nullptr;
+                update(timer.fd, entry);
+                if (!entry.registered)
+                    watches.erase(watch_it);
+            }
+        }
+        timer.handle.resume();
+    }
+}
+
+/* Arms the timerfd for the earliest deadline -- epoll_wait() itself only waits in whole milliseconds. */
+int EventLoop::timeout() {
+    if (timers.empty())
+        return -1;
+
+    const auto deadline = timers.top().deadline;
+    if (deadline <= Clock::now())
+        return 0;
+    if (armed == deadline)
+        return -1;
+
+    const auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    itimerspec specification{};
+    specification.it_value.tv_sec = static_cast<time_t>(since_epoch / 1'000'000'000);
+    specification.it_value.tv_nsec = static_cast<long>(since_epoch % 1'000'000'000);
+    if (::timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &specification, nullptr) == -1)
+        throw std::runtime_error{strerror(errno)};
+    armed = deadline;
+    return -1;
+}
+
+void EventLoop::run() {
+    std::array<epoll_event, MAX_EVENTS> events{};
+    std::vector<std::coroutine_handle<>> ready{};
+
+    while (!stopped) {
+        const int count = ::epoll_wait(epoll_fd, events.data(), MAX_EVENTS, timeout());
+        if (count == -1) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error{strerror(errno)};
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[static_cast<std::size_t>(i)].data.fd;
+            const unsigned flags = events[static_cast<std::size_t>(i)].events;
+
+            if (fd == wake_fd || fd == timer_fd) {
+                std::uint64_t value;
+                [[maybe_unused]] auto result = ::read(fd, &value, sizeof(value));
+                if (fd == timer_fd)
+                    armed.reset();
+                continue;
+            }
+
+            auto it = watches.find(fd);
+            if (it == watches.end())
+                continue;
+
+            Watch &entry = it->second;
+            const bool failed = flags & (EPOLLERR | EPOLLHUP);
+            if (entry.reader && (failed || (flags & EPOLLIN)))
+                ready.push_back(release(*std::exchange(entry.reader, nullptr)));
+            if (entry.writer && (failed || (flags & EPOLLOUT)))
+                ready.push_back(release(*std::exchange(entry.writer, nullptr)));
+
+            update(fd, entry);
+            if (!entry.registered)
+                watches.erase(it);
+        }
+
+        // Resuming a coroutine may change the set of watched descriptors,
+        // hence it is done only after the events have been processed.
+        for (auto handle : ready)
+            handle.resume();
+        ready.clear();
+
+        resume_expired();
+        resume_posted();
+    }
+}
+
+void EventLoop::stop() {
+    stopped = true;
+    wake();
+}
+
+} // namespace SK
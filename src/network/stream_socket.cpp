@@ -0,0 +1,230 @@
+#include <network/socket_options.h>
+#include <utilities/miscellaneous.h>
+#include <network/stream_socket.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <bit>      // std::endian
+#include <cstddef>  // offsetof
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace SK {
+
+StreamSocket::StreamSocket(int domain, int protocol) {
+    socket_fd = ::socket(domain, SOCK_STREAM, protocol);
+    if (socket_fd == -1)
+        throw std::runtime_error{strerror(errno)}; // TODO
+}
+
+StreamSocket::StreamSocket(StreamSocket &&other) {
+    if (socket_fd != -1)
+        close(socket_fd);
+    socket_fd = other.socket_fd;
+    other.socket_fd = -1;
+}
+
+StreamSocket &StreamSocket::operator=(StreamSocket &&other) {
+    if (socket_fd != -1)
+        close(socket_fd);
+    socket_fd = other.socket_fd;
+    other.socket_fd = -1;
+    return *this;
+}
+
+StreamSocket::~StreamSocket() {
+    if (socket_fd != -1) {
+        close(socket_fd);
+        socket_fd = -1;
+    }
+}
+
+void StreamSocket::set_socket_blocking(bool value) {
+    if (socket_fd == -1)
+        return;
+    int flags = ::fcntl(socket_fd, F_GETFL, 0);
+    if (flags == -1)
+        return;
+    flags = value ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+    if (::fcntl(socket_fd, F_SETFL, flags) != 0)
+        throw std::runtime_error{strerror(errno)}; // TODO
+}
+
+namespace {
+
+inline decltype(auto) get_option_value(const auto &option) {
+    using type          = std::decay_t<decltype(option)>;
+    using value_type    = typename type::value_type;
+
+    if constexpr (std::same_as<value_type, bool>) {
+        return static_cast<int>(option.value);
+    } else if constexpr (std::same_as<type, ReceiveTimeout>) {
+        timeval result;
+        result.tv_sec = option.value / 1000;
+        result.tv_usec = (option.value % 1000) * 1000;
+        return result;
+    } else {
+        return option.value;
+    }
+}
+
+} // anonymous namespace
+
+StreamSocket &StreamSocket::set_socket_option(const SocketOption &option) {
+    auto set_option = [&](const auto &value, auto level, auto optname) {
+        return ::setsockopt(
+            socket_fd,
+            to_underlying(level),
+            to_underlying(optname),
+            reinterpret_cast<const void*>(&value),
+            static_cast<socklen_t>(sizeof(value))
+        );
+    };
+
+    auto resolve_error = [](int error) {
+        if (error == -1)
+            throw std::runtime_error{strerror(errno)}; // TODO
+    };
+
+    resolve_error(std::visit(
+        [&](const auto &value) {
+            using type          = std::decay_t<decltype(value)>;
+            const auto level    = type::option_level;
+            const auto optname  = type::option_type;
+
+            return set_option(get_option_value(value), level, optname);
+        },
+        option
+    ));
+
+    return *this;
+}
+
+void StreamSocket::listen(int queue_length) {
+    if (::listen(socket_fd, queue_length) == -1)
+        throw std::runtime_error{"TODO"}; // TODO
+}
+
+std::optional<StreamSocket> StreamSocket::accept() {
+    int sock_fd = ::accept(socket_fd, nullptr, nullptr);
+    if (sock_fd == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return std::nullopt;
+        throw std::runtime_error{strerror(errno)}; // TODO
+    }
+    return StreamSocket{sock_fd};
+}
+
+bool StreamSocket::wait_readable(std::chrono::milliseconds timeout) const {
+    const StreamSocket *self = this;
+    return wait_readable(std::span<const StreamSocket* const>{&self, 1}, timeout);
+}
+
+bool StreamSocket::wait_readable(std::span<const StreamSocket* const> sockets, std::chrono::milliseconds timeout) {
+    std::vector<pollfd> descriptors(sockets.size());
+    for (std::size_t i = 0; i < sockets.size(); ++i) {
+        descriptors[i].fd = sockets[i]->socket_fd;
+        descriptors[i].events = POLLIN;
+    }
+
+    const int result = ::poll(descriptors.data(), static_cast<nfds_t>(descriptors.size()), static_cast<int>(timeout.count()));
+    if (result == -1) {
+        if (errno == EINTR)
+            return false;
+        throw std::runtime_error{std::string{"[StreamSocket: wait_readable] "} + strerror(errno)};
+    }
+    // An error is reported as readiness too, so that the next call fails and tells which one.
+    return result > 0;
+}
+
+std::string StreamSocket::peer_address() const {
+    sockaddr_storage storage{};
+    socklen_t length = static_cast<socklen_t>(sizeof(storage));
+    if (::getpeername(socket_fd, reinterpret_cast<sockaddr*>(&storage), &length) == -1)
+        throw std::runtime_error{strerror(errno)};
+
+    if (storage.ss_family == AF_UNIX) {
+        const auto &address = reinterpret_cast<const sockaddr_un&>(storage);
+        const std::size_t path_length = static_cast<std::size_t>(length) - offsetof(sockaddr_un, sun_path);
+        // A client which has not bound its socket is unnamed.
+        if (!path_length)
+            return "unix";
+        // An abstract name starts with a null byte, shown as '@'.
+        if (address.sun_path[0] == '\0')
+            return "unix:@" + std::string{address.sun_path + 1, path_length - 1};
+        return "unix:" + std::string{address.sun_path};
+    }
+
+    const auto &address = reinterpret_cast<const sockaddr_in6&>(storage);
+    char buffer[INET6_ADDRSTRLEN]{};
+    if (!::inet_ntop(AF_INET6, &address.sin6_addr, buffer, sizeof(buffer)))
+        throw std::runtime_error{strerror(errno)};
+
+    const std::uint16_t port = [&]() {
+        if constexpr (std::endian::native == std::endian::big)
+            return address.sin6_port;
+        else
+            return swap_endiannes(address.sin6_port);
+    }();
+    return "[" + std::string{buffer} + "]:" + std::to_string(port);
+}
+
+std::size_t StreamSocket::receive(std::span<std::byte> span) const {
+    /* TODO: flags */
+    ssize_t result = ::recv(socket_fd, reinterpret_cast<void*>(span.data()), span.size_bytes(), 0);
+    if (result == -1)
+        throw std::runtime_error{"TODO"}; // TODO
+    return static_cast<std::size_t>(result);
+}
+
+void StreamSocket::send(std::span<std::byte> span) const {
+    /* TODO: flags */
+    ssize_t sent_size = ::send(socket_fd, reinterpret_cast<const void*>(span.data()), span.size_bytes(), 0);
+    if (sent_size == -1 || static_cast<std::size_t>(sent_size) != span.size_bytes())
+        throw std::runtime_error{"TODO"}; // TODO
+}
+
+std::optional<std::size_t> StreamSocket::try_receive(std::span<std::byte> span) const {
+    while (true) {
+        const ssize_t result = ::recv(socket_fd, reinterpret_cast<void*>(span.data()), span.size_bytes(), 0);
+        if (result != -1)
+            return static_cast<std::size_t>(result);
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return std::nullopt;
+        if (errno != EINTR)
+            throw std::runtime_error{strerror(errno)};
+    }
+}
+
+std::size_t StreamSocket::send_some(std::span<std::byte> span) const {
+    ssize_t sent_size = ::send(socket_fd, reinterpret_cast<const void*>(span.data()), span.size_bytes(), MSG_NOSIGNAL);
+    if (sent_size == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+        throw std::runtime_error{strerror(errno)};
+    }
+    return static_cast<std::size_t>(sent_size);
+}
+
+std::size_t StreamSocket::send_file_some(int file_fd, std::uint64_t offset, std::size_t count) const {
+    // sendfile() takes no flags -- the caller has to ignore SIGPIPE itself.
+    off_t position = static_cast<off_t>(offset);
+    ssize_t sent_size = ::sendfile(socket_fd, file_fd, &position, count);
+    if (sent_size == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+        throw std::runtime_error{strerror(errno)};
+    }
+    return static_cast<std::size_t>(sent_size);
+}
+
+} // namespace SK
@@ -0,0 +1,143 @@
+#include <network/unix_socket.h>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>      // offsetof
+#include <cstring>
+#include <stdexcept>
+#include <utility>      // std::move
+
+namespace SK {
+
+namespace {
+
+/* Returns the length of the address, which for an abstract name does not include a terminating null byte. */
+socklen_t make_address(const std::string &path, sockaddr_un &address) {
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+        throw std::invalid_argument{"[UnixSocket: make_address] The path has to have between 1 and 107 characters."};
+
+    std::memcpy(address.sun_path, path.data(), path.size());
+    if (path[0] == '@') {
+        address.sun_path[0] = '\0';
+        return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size());
+    }
+    return static_cast<socklen_t>(sizeof(address));
+}
+
+} // anonymous namespace
+
+UnixSocket::UnixSocket()
+: StreamSocket{AF_UNIX, 0} {}
+
+UnixSocket::UnixSocket(StreamSocket &&socket)
+: StreamSocket{std::move(socket)} {}
+
+void UnixSocket::bind(const std::string &path) {
+    sockaddr_un address{};
+    const socklen_t length = make_address(path, address);
+
+    struct stat status{};
+    if (path[0] != '@' && ::stat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+        // Stale only if nobody answers -- otherwise another server would be cut off its clients.
+        bool listening = true;
+        try {
+            UnixSocket{}.connect(path);
+        } catch (const std::runtime_error&) {
+            listening = false;
+        }
+        if (listening)
+            throw std::runtime_error{"[UnixSocket: bind] " + path + " is in use."};
+        ::unlink(path.c_str());
+    }
+
+    if (::bind(socket_fd, reinterpret_cast<const sockaddr*>(&address), length) == -1)
+        throw std::runtime_error{std::string{"[UnixSocket: bind] "} + strerror(errno)};
+}
+
+void UnixSocket::connect(const std::string &path) {
+    sockaddr_un address{};
+    const socklen_t length = make_address(path, address);
+
+    if (::connect(socket_fd, reinterpret_cast<const sockaddr*>(&address), length) == -1)
+        throw std::runtime_error{std::string{"[UnixSocket: connect] "} + strerror(errno)};
+}
+
+void UnixSocket::send_descriptors(std::span<const std::byte> bytes, std::span<const int> descriptors) const {
+    if (bytes.empty() || descriptors.size() > MAX_DESCRIPTORS)
+        throw std::invalid_argument{"[UnixSocket: send_descriptors] Some bytes and at most MAX_DESCRIPTORS descriptors have to be sent."};
+
+    alignas(cmsghdr) std::byte control[CMSG_SPACE(MAX_DESCRIPTORS * sizeof(int))]{};
+    iovec vector{const_cast<std::byte*>(bytes.data()), bytes.size()};
+    msghdr message{};
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    if (!descriptors.empty()) {
+        message.msg_control = control;
+        message.msg_controllen = CMSG_SPACE(descriptors.size() * sizeof(int));
+        cmsghdr *header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(descriptors.size() * sizeof(int));
+        std::memcpy(CMSG_DATA(header), descriptors.data(), descriptors.size() * sizeof(int));
+    }
+
+    // The descriptors go with the first chunk -- the rest of the bytes follows on its own.
+    std::size_t sent = 0;
+    while (sent < bytes.size()) {
+        const ssize_t result = ::sendmsg(socket_fd, &message, MSG_NOSIGNAL);
+        if (result == -1) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error{std::string{"[UnixSocket: send_descriptors] "} + strerror(errno)};
+        }
+        sent += static_cast<std::size_t>(result);
+        vector = iovec{const_cast<std::byte*>(bytes.data() + sent), bytes.size() - sent};
+        message.msg_control = nullptr;
+        message.msg_controllen = 0;
+    }
+}
+
+std::vector<StreamSocket> UnixSocket::receive_descriptors(std::span<std::byte> bytes) const {
+    std::vector<StreamSocket> sockets{};
+    alignas(cmsghdr) std::byte control[CMSG_SPACE(MAX_DESCRIPTORS * sizeof(int))]{};
+
+    std::size_t received = 0;
+    while (received < bytes.size()) {
+        iovec vector{bytes.data() + received, bytes.size() - received};
+        msghdr message{};
+        message.msg_iov = &vector;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        const ssize_t result = ::recvmsg(socket_fd, &message, MSG_CMSG_CLOEXEC);
+        if (result == -1) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error{std::string{"[UnixSocket: receive_descriptors] "} + strerror(errno)};
+        }
+        if (result == 0)
+            throw std::runtime_error{"[UnixSocket: receive_descriptors] The connection has been closed."};
+        received += static_cast<std::size_t>(result);
+
+        for (cmsghdr *header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+            if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS)
+                continue;
+            const std::size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            std::vector<int> descriptors(count);
+            std::memcpy(descriptors.data(), CMSG_DATA(header), count * sizeof(int));
+            for (const int descriptor : descriptors)
+                sockets.push_back(StreamSocket::adopt(descriptor));
+        }
+        if (message.msg_flags & MSG_CTRUNC)
+            throw std::runtime_error{"[UnixSocket: receive_descriptors] Some of the descriptors have been lost."};
+    }
+    return sockets;
+}
+
+} // namespace SK
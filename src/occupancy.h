@@ -0,0 +1,149 @@
+#ifndef __SK_OCCUPANCY_H__
+#define __SK_OCCUPANCY_H__
+
+#include <messages/common.h>
+
+#include <array>
+#include <bit>              // std::countr_zero
+#include <cstddef>          // std::size_t
+#include <limits>
+#include <unordered_map>
+
+#include "board.h"
+
+namespace SK {
+
+/* A set of players -- one bit per possible PlayerId. */
+class PlayerMask {
+private:
+    using Word = u64;
+
+    constexpr static std::size_t WORD_BITS = 64;
+    constexpr static std::size_t WORDS = (std::numeric_limits<PlayerId>::max() + std::size_t{1}) / WORD_BITS;
+
+    std::array<Word, WORDS> words{};
+
+public:
+    void set(PlayerId id) {
+        words[id / WORD_BITS] |= Word{1} << (id % WORD_BITS);
+    }
+
+    void reset(PlayerId id) {
+        words[id / WORD_BITS] &= ~(Word{1} << (id % WORD_BITS));
+    }
+
+    bool test(PlayerId id) const {
+        return words[id / WORD_BITS] & (Word{1} << (id % WORD_BITS));
+    }
+
+    bool none() const {
+        for (const Word word : words)
+            if (word)
+                return false;
+        return true;
+    }
+
+    PlayerMask &operator|=(const PlayerMask &other) {
+        for (std::size_t i = 0; i < WORDS; ++i)
+            words[i] |= other.words[i];
+        return *this;
+    }
+
+    /* Calls f(id) for every player in the set, by increasing IDs. */
+    template<typename F>
+    void for_each(F &&f) const {
+        for (std::size_t i = 0; i < WORDS; ++i) {
+            Word word = words[i];
+            while (word) {
+                f(static_cast<PlayerId>(i * WORD_BITS + static_cast<std::size_t>(std::countr_zero(word))));
+                word &= word - 1;
+            }
+        }
+    }
+};
+
+/*
+    Occupancy -- which robots stand on which cells, maintained incrementally.
+
+    Occupied cells are marked in a pair of bit matrices (row-major and
+    column-major), while the players standing on a cell are kept in a mask
+    stored only for occupied cells. Finding the robots hit by an explosion
+    is then a word scan over each arm plus a union of the masks found on it.
+*/
+class Occupancy {
+private:
+    u16 size_x = 0;
+    BitMatrix rows{};
+    BitMatrix columns{};
+    std::unordered_map<u32, PlayerMask> masks{};
+
+public:
+    Occupancy() = default;
+
+    Occupancy(u16 size_x_, u16 size_y_)
+    : size_x{size_x_}
+    , rows{size_y_, size_x_}
+    , columns{size_x_, size_y_} {}
+
+    void add(PlayerId id, Cell cell) {
+        PlayerMask &mask = masks[key(cell)];
+        if (mask.none()) {
+            rows.set(cell.y, cell.x);
+            columns.set(cell.x, cell.y);
+        }
+        mask.set(id);
+    }
+
+    void remove(PlayerId id, Cell cell) {
+        auto it = masks.find(key(cell));
+        if (it == masks.end())
+            return;
+
+        it->second.reset(id);
+        if (it->second.none()) {
+            rows.reset(cell.y, cell.x);
+            columns.reset(cell.x, cell.y);
+            masks.erase(it);
+        }
+    }
+
+    void move(PlayerId id, Cell from, Cell to) {
+        if (from == to)
+            return;
+        remove(id, from);
+        add(id, to);
+    }
+
+    /* The players standing in row y between the columns from_x and to_x (inclusive). */
+    PlayerMask in_row(u16 y, u16 from_x, u16 to_x) const {
+        PlayerMask result{};
+        rows.for_each_in(y, from_x, to_x, [&](std::size_t x) {
+            result |= masks.at(key(Cell{static_cast<u16>(x), y}));
+        });
+        return result;
+    }
+
+    /* The players standing in column x between the rows from_y and to_y (inclusive). */
+    PlayerMask in_column(u16 x, u16 from_y, u16 to_y) const {
+        PlayerMask result{};
+        columns.for_each_in(x, from_y, to_y, [&](std::size_t y) {
+            result |= masks.at(key(Cell{x, static_cast<u16>(y)}));
+        });
+        return result;
+    }
+
+    void clear() {
+        rows.clear();
+        columns.clear();
+        masks.clear();
+    }
+
+private:
+    u32 key(Cell cell) const {
+        return static_cast<u32>(cell.y) * size_x + cell.x;
+    }
+};
+
+} // namespace SK
+
+#endif // __SK_OCCUPANCY_H__
@@ -0,0 +1,159 @@
+#ifndef __SK_PLAYER_TABLE_H__
+#define __SK_PLAYER_TABLE_H__
+
+#include <messages/client_messages.h>
+#include <messages/common.h>
+#include <messages/network_string.h>
+#include <utilities/miscellaneous.h>
+
+#include <algorithm>    // std::fill
+#include <array>
+#include <cstddef>      // std::size_t, std::ptrdiff_t
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+#include "board.h"
+
+namespace SK {
+
+/* Passed as the capacity of a PlayerTable, lets the number of players be chosen at runtime. */
+constexpr std::size_t DYNAMIC_PLAYERS = 0;
+
+/* The last action of a player in a turn, squeezed into a single byte. */
+enum class PendingAction : u8 {
+    NONE,
+    PLACE_BOMB,
+    PLACE_BLOCK,
+    MOVE_UP,
+    MOVE_RIGHT,
+    MOVE_DOWN,
+    MOVE_LEFT
+};
+
+inline PendingAction to_pending_action(const std::optional<ClientMessage> &message) {
+    if (!message)
+        return PendingAction::NONE;
+    if (std::holds_alternative<PlaceBomb>(*message))
+        return PendingAction::PLACE_BOMB;
+    if (std::holds_alternative<PlaceBlock>(*message))
+        return PendingAction::PLACE_BLOCK;
+    if (const Move *move = std::get_if<Move>(&*message))
+        // The variant lists the directions in the same order as the enumeration.
+        return static_cast<PendingAction>(to_underlying(PendingAction::MOVE_UP) + move->get<"direction">().index());
+    // Join is ignored during the game.
+    return PendingAction::NONE;
+}
+
+namespace detail {
+
+template<typename T, std::size_t Capacity>
+struct PlayerColumn {
+    std::array<T, Capacity> values{};
+
+    PlayerColumn(std::size_t) {}
+};
+
+template<typename T>
+struct PlayerColumn<T, DYNAMIC_PLAYERS> {
+    std::vector<T> values;
+
+    PlayerColumn(std::size_t count)
+    : values(count) {}
+};
+
+} // namespace detail
+
+/*
+    PlayerTable -- the state of the robots touched by the simulation every turn,
+    stored as a structure of arrays. With a fixed capacity, the columns are plain
+    arrays and the loops over the players have a bound known at compile time:
+    they run over every slot, and the slots past the players of the game are
+    masked out by present() -- such a slot is never alive and has no action.
+*/
+template<std::size_t MaxPlayers = DYNAMIC_PLAYERS>
+class PlayerTable {
+private:
+    std::size_t count;
+
+    detail::PlayerColumn<u16, MaxPlayers> xs;
+    detail::PlayerColumn<u16, MaxPlayers> ys;
+    detail::PlayerColumn<u8, MaxPlayers> present_flags;
+    detail::PlayerColumn<u8, MaxPlayers> alive_flags;
+    detail::PlayerColumn<Score, MaxPlayers> deaths;
+    detail::PlayerColumn<PendingAction, MaxPlayers> actions;
+
+public:
+    PlayerTable(std::size_t count_)
+    : count{count_}
+    , xs{count_}
+    , ys{count_}
+    , present_flags{count_}
+    , alive_flags{count_}
+    , deaths{count_}
+    , actions{count_}
+    {
+        if (MaxPlayers != DYNAMIC_PLAYERS && count_ > MaxPlayers)
+            throw std::invalid_argument{"[PlayerTable] The number of players exceeds the capacity of the table."};
+        std::fill(present_flags.values.begin(), present_flags.values.begin() + static_cast<std::ptrdiff_t>(count), u8{1});
+    }
+
+    constexpr static std::size_t capacity() {
+        return MaxPlayers;
+    }
+
+    /* The number of players. */
+    std::size_t size() const {
+        return count;
+    }
+
+    /* The number of slots -- the capacity if it is fixed, so a loop bounded by it is unrolled. */
+    std::size_t slots() const {
+        if constexpr (MaxPlayers != DYNAMIC_PLAYERS)
+            return MaxPlayers;
+        else
+            return count;
+    }
+
+    /* The columns have an entry for every slot. */
+    std::span<u16> x() { return {xs.values.data(), slots()}; }
+    std::span<u16> y() { return {ys.values.data(), slots()}; }
+    std::span<u8> alive() { return {alive_flags.values.data(), slots()}; }
+    std::span<Score> death_count() { return {deaths.values.data(), slots()}; }
+    std::span<PendingAction> pending() { return {actions.values.data(), slots()}; }
+
+    std::span<const u16> x() const { return {xs.values.data(), slots()}; }
+    std::span<const u16> y() const { return {ys.values.data(), slots()}; }
+    std::span<const u8> present() const { return {present_flags.values.data(), slots()}; }
+    std::span<const u8> alive() const { return {alive_flags.values.data(), slots()}; }
+    std::span<const Score> death_count() const { return {deaths.values.data(), slots()}; }
+    std::span<const PendingAction> pending() const { return {actions.values.data(), slots()}; }
+
+    Cell position(std::size_t id) const {
+        return Cell{xs.values[id], ys.values[id]};
+    }
+
+    void set_position(std::size_t id, Cell cell) {
+        xs.values[id] = cell.x;
+        ys.values[id] = cell.y;
+    }
+};
+
+/*
+    PlayerRoster -- the data of the players the simulation never looks at,
+    kept apart so that it does not get dragged through the cache.
+*/
+struct PlayerRoster {
+    struct Entry {
+        String name;
+        String address;
+    };
+
+    std::vector<Entry> entries{};
+};
+
+} // namespace SK
+
+#endif // __SK_PLAYER_TABLE_H__
@@ -8,6 +8,25 @@ namespace SK {
 std::uint32_t get_seed();
 std::uint32_t rand(std::uint32_t seed);
 
+/* The generator from the specification -- every call advances its state by SK::rand. */
+class Random {
+private:
+    std::uint32_t state;
+
+public:
+    Random(std::uint32_t seed)
+    : state{seed} {}
+
+    std::uint32_t operator()() {
+        state = SK::rand(state);
+        return state;
+    }
+
+    std::uint32_t get_state() const {
+        return state;
+    }
+};
+
 } // namespace SK
 
 #endif // __SK_RANDOM_H__
@@ -0,0 +1,158 @@
+/*
+ * robots-replay -- serves a recorded game (see GameRecorder) to observers.
+ *
+ * Every client is sent the game from the start as soon as it connects,
+ * a turn every turn duration, just as if it were watching it live. The
+ * recording is sent straight from the file with sendfile(), so a replay
+ * costs no more than the page cache, whatever the number of observers.
+ *
+ * The replay may start at any turn: the index of the recording locates
+ * it at once. As a turn only holds what has changed since the previous
+ * one -- and a client counts the bomb timers down once per Turn -- the turns
+ * before it are all sent first, as they are, in a single sendfile().
+ */
+
+#include <network/async_socket.h>
+#include <network/event_loop.h>
+#include <network/socket.h>
+#include <network/socket_options.h>
+#include <network/unix_socket.h>
+#include <utilities/miscellaneous.h>
+#include <utilities/task.h>
+
+#include "game_recording.h"
+
+#include <getopt.h> // getopt_long
+
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdlib>  // EXIT_FAILURE
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <iostream>
+
+using namespace SK;
+
+namespace {
+
+using Clock = EventLoop::Clock;
+
+struct Options {
+    std::string path{};
+    u16 port = 0;
+    std::string unix_path{};    // listens on a Unix domain socket instead, if set
+    u64 turn_duration = 0;      // in ms
+    std::size_t first_turn = 0;
+};
+
+Options parse_options(int argc, char *argv[]) {
+    const option long_options[] = {
+        {"file",          required_argument, nullptr, 'f'},
+        {"port",          required_argument, nullptr, 'p'},
+        {"unix-socket",   required_argument, nullptr, 'u'},
+        {"turn-duration", required_argument, nullptr, 'd'},
+        {"from-turn",     required_argument, nullptr, 'T'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    Options options{};
+    int option;
+    while ((option = getopt_long(argc, argv, "f:p:u:d:T:", long_options, nullptr)) != -1) {
+        switch (option) {
+            case 'f': options.path = optarg; break;
+            case 'p': options.port = parse_number<u16>(optarg, 'p'); break;
+            case 'u': options.unix_path = optarg; break;
+            case 'd': options.turn_duration = parse_number<u64>(optarg, 'd'); break;
+            case 'T': options.first_turn = parse_number<std::size_t>(optarg, 'T'); break;
+            default:
+                throw std::invalid_argument{"[parse_options] Unknown option."};
+        }
+    }
+
+    if (options.path.empty() || (!options.port && options.unix_path.empty()) || !options.turn_duration)
+        throw std::invalid_argument{"[parse_options] All of -f, -p (or -u) and -d are required."};
+    return options;
+}
+
+StreamSocket listen(const Options &options) {
+    if (!options.unix_path.empty()) {
+        UnixSocket socket{};
+        socket.bind(options.unix_path);
+        socket.set_socket_blocking(false);
+        socket.listen(64);
+        return socket;
+    }
+
+    TCPSocket socket{};
+    socket.set_socket_option(ReusePort{true});
+    socket.bind(options.port);
+    socket.set_socket_blocking(false);
+    socket.listen(64);
+    return socket;
+}
+
+Task<bool> send(AsyncSocket &socket, const GameRecording &recording, Recording::Range range) {
+    const bool sent = co_await socket.write_file(recording.native_handle(), range.begin, range.size());
+    co_return sent;
+}
+
+Task<void> replay(AsyncSocket socket, const GameRecording &recording, const Options &options) {
+    try {
+        // Hello, GameStarted and the turns before the first one replayed -- one after another in the file.
+        const Recording::Range catch_up{recording.prologue().begin, recording.turn(options.first_turn).begin};
+        bool sent = co_await send(socket, recording, catch_up);
+
+        auto deadline = Clock::now();
+        for (std::size_t i = options.first_turn; sent && i < recording.turns(); ++i) {
+            if (i > options.first_turn) {
+                deadline += std::chrono::milliseconds{options.turn_duration};
+                co_await socket.loop().sleep_until(deadline);
+            }
+            sent = co_await send(socket, recording, recording.turn(i));
+        }
+
+        if (sent)
+            co_await send(socket, recording, recording.epilogue());
+    } catch (const std::exception&) {
+        // The observer has gone.
+    }
+}
+
+Task<void> accept(EventLoop &loop, StreamSocket &listener, const GameRecording &recording, const Options &options) {
+    while (true) {
+        const bool ready = co_await loop.readable(listener.native_handle());
+        if (!ready)
+            co_return;
+        while (auto socket = listener.accept())
+            spawn(replay(AsyncSocket{std::move(socket).value(), loop}, recording, options));
+    }
+}
+
+void run(const Options &options) {
+    const GameRecording recording{options.path};
+    if (options.first_turn >= recording.turns())
+        throw std::invalid_argument{"[run] The game has only " + std::to_string(recording.turns()) + " turns."};
+
+    StreamSocket listener = listen(options);
+    EventLoop loop{};
+    spawn(accept(loop, listener, recording, options));
+    loop.run();
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+    // sendfile() cannot be told not to raise it.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    try {
+        run(parse_options(argc, argv));
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef __SK_ROOM_CHECKPOINT_H__
+#define __SK_ROOM_CHECKPOINT_H__
+
+#include <messages/common.h>
+#include <messages/message.h>
+#include <messages/network_list.h>
+#include <messages/network_string.h>
+#include <messages/server_messages.h>
+
+namespace SK {
+
+/*
+    The state of a room, as handed over to the next server -- see GameRoom::hand_over().
+    It is serialised by the Serializer, like the messages of the protocol.
+
+    A game is not stored as the state of the board: it is determined by
+    the state of the generator when it has started and by the actions of
+    the players, so the next server plays it again -- which takes far less
+    time than a turn lasts -- and gets the very same messages, byte for byte.
+    That is what lets the clients carry on from where they were in the feed.
+*/
+using ClientCheckpoint = BasicMessage<
+    Field<String, "address">,
+    Field<u8, "is_player">,
+    Field<PlayerId, "player">,
+    Field<u64, "position">,         // how many messages of the feed the client has been sent
+    Field<List<u8>, "input">        // what the client has sent but is not a complete message yet
+>;
+
+using RoomCheckpoint = BasicMessage<
+    // The parameters which determine a game -- a room restored with different ones starts afresh.
+    Field<u8, "players_count">,
+    Field<u16, "size_x">,
+    Field<u16, "size_y">,
+    Field<u16, "game_length">,
+    Field<u16, "explosion_radius">,
+    Field<u16, "bomb_timer">,
+    Field<u16, "initial_blocks">,
+
+    Field<u32, "random_state">,     // when the game has started, if there is one, or now
+    Field<u64, "games_played">,
+    Field<List<Player>, "roster">,
+    Field<u8, "in_game">,
+    Field<List<u8>, "actions">,     // of every turn played so far, players_count per turn
+    Field<List<u8>, "pending">,     // the actions for the next turn
+    Field<List<ClientCheckpoint>, "clients">
+>;
+
+} // namespace SK
+
+#endif // __SK_ROOM_CHECKPOINT_H__
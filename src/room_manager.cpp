@@ -0,0 +1,146 @@
+#include "room_manager.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <utilities/logger.h>
+#include <utilities/tracer.h>
+
+#include <algorithm>    // std::max, std::min
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>      // std::move
+
+namespace SK {
+
+namespace {
+
+// Several hundred turns of a large board -- an observer lagging further behind has to resync.
+constexpr std::size_t SHARED_FEED_CAPACITY = std::size_t{1} << 22;
+
+void pin_to_core(std::thread &thread, std::size_t core) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    // Pinning is only a hint -- the worker runs just as well if it fails.
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+}
+
+} // anonymous namespace
+
+RoomManager::RoomManager(
+    const std::vector<ServerParameters> &parameters,
+    std::size_t worker_count,
+    const SlowClientPolicy &slow_clients,
+    const std::string &shared_feed,
+    const std::string &recordings,
+    const std::string &input_traces
+) {
+    if (parameters.empty())
+        throw std::invalid_argument{"[RoomManager: RoomManager] There has to be at least one room."};
+
+    worker_count = std::max<std::size_t>(std::min(worker_count, parameters.size()), 1);
+    const std::size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (std::size_t i = 0; i < worker_count; ++i)
+        workers.push_back(std::make_unique<Worker>());
+
+    for (std::size_t i = 0; i < parameters.size(); ++i) {
+        Worker &worker = *workers[i % worker_count];
+        std::optional<SharedRing> ring = std::nullopt;
+        if (!shared_feed.empty())
+            ring.emplace("/" + shared_feed + "." + std::to_string(i), SHARED_FEED_CAPACITY);
+        const std::string recording_prefix = recordings.empty() ? std::string{} : recordings + "/room" + std::to_string(i);
+        const std::string input_trace = input_traces.empty() ? std::string{} : input_traces + "/room" + std::to_string(i) + ".trace";
+        rooms.push_back(std::make_unique<GameRoom>(
+            parameters[i], worker.loop, slow_clients, connection_stats, stats, std::move(ring), recording_prefix, input_trace
+        ));
+        // The loop is not running yet, so the room starts on its thread.
+        spawn(rooms.back()->run());
+    }
+
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        Worker &worker = *workers[i];
+        worker.thread = std::thread{[&worker, i] {
+            Tracer::instance().name_thread("worker " + std::to_string(i));
+            Logger::instance().name_thread("worker " + std::to_string(i));
+            worker.loop.run();
+        }};
+        pin_to_core(worker.thread, i % cores);
+    }
+}
+
+RoomManager::~RoomManager() {
+    for (auto &worker : workers)
+        worker->loop.stop();
+    for (auto &worker : workers)
+        if (worker->thread.joinable())
+            worker->thread.join();
+}
+
+Task<void> RoomManager::admit(GameRoom &room, StreamSocket socket) {
+    co_await room.loop().schedule();
+    room.admit(std::move(socket));
+}
+
+void RoomManager::route(StreamSocket &&socket) {
+    const std::size_t start = next_room.fetch_add(1, std::memory_order_relaxed);
+
+    // The first room with a free slot in its lobby, starting from the next one in turn.
+    for (std::size_t i = 0; i < rooms.size(); ++i) {
+        GameRoom &room = *rooms[(start + i) % rooms.size()];
+        if (room.reserve()) {
+            spawn(admit(room, std::move(socket)));
+            return;
+        }
+    }
+
+    // Every game is full -- the client will be an observer.
+    spawn(admit(*rooms[start % rooms.size()], std::move(socket)));
+}
+
+Task<void> RoomManager::hand_over(GameRoom &room, std::promise<GameRoom::Handover> &promise) {
+    co_await room.loop().schedule();
+    promise.set_value(co_await room.hand_over());
+}
+
+std::vector<GameRoom::Handover> RoomManager::hand_over() {
+    // The rooms wait for their turns at once, on their own threads.
+    std::vector<std::promise<GameRoom::Handover>> promises(rooms.size());
+    std::vector<std::future<GameRoom::Handover>> futures{};
+    for (auto &promise : promises)
+        futures.push_back(promise.get_future());
+    for (std::size_t i = 0; i < rooms.size(); ++i)
+        spawn(hand_over(*rooms[i], promises[i]));
+
+    std::vector<GameRoom::Handover> handovers{};
+    for (auto &future : futures)
+        handovers.push_back(future.get());
+    return handovers;
+}
+
+Task<void> RoomManager::restore(GameRoom &room, GameRoom::Handover &handover, std::promise<void> &promise) {
+    co_await room.loop().schedule();
+    room.restore(handover.checkpoint, std::move(handover.clients));
+    promise.set_value();
+}
+
+void RoomManager::restore(std::vector<GameRoom::Handover> &&handovers) {
+    // The rooms left over have nobody to take them over -- their clients are disconnected.
+    if (handovers.size() != rooms.size())
+        log_warning("rooms_mismatch", {{"previous", handovers.size()}, {"current", rooms.size()}});
+
+    const std::size_t count = std::min(handovers.size(), rooms.size());
+    std::vector<std::promise<void>> promises(count);
+    std::vector<std::future<void>> futures{};
+    for (auto &promise : promises)
+        futures.push_back(promise.get_future());
+    for (std::size_t i = 0; i < count; ++i)
+        spawn(restore(*rooms[i], handovers[i], promises[i]));
+    for (auto &future : futures)
+        future.get();
+}
+
+} // namespace SK
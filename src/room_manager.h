@@ -0,0 +1,102 @@
+#ifndef __SK_ROOM_MANAGER_H__
+#define __SK_ROOM_MANAGER_H__
+
+#include <network/event_loop.h>
+#include <network/stream_socket.h>
+#include <utilities/task.h>
+
+#include <atomic>
+#include <cstddef>
+#include <future>
+#include <memory>   // std::unique_ptr
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game_room.h"
+#include "connection_stats.h"
+#include "server_state.h"
+#include "turn_stats.h"
+
+namespace SK {
+
+/*
+    RoomManager -- hosts many independent games at once.
+
+    Every worker thread runs its own EventLoop and is pinned to a core;
+    the rooms are spread over the workers and never leave them, so
+    the games do not share any state. Newcomers are routed to a room
+    with a free slot in its lobby, or to any room as observers.
+*/
+class RoomManager {
+private:
+    struct Worker {
+        EventLoop loop{};
+        std::thread thread{};
+    };
+
+    // Declared first, so that they outlive the rooms recording into them.
+    TurnStats stats{};
+    ConnectionStats connection_stats{};
+
+    std::vector<std::unique_ptr<Worker>> workers{};
+    std::vector<std::unique_ptr<GameRoom>> rooms{};
+    std::atomic<std::size_t> next_room = 0;
+
+public:
+    /*
+        One room for every set of parameters. Unless shared_feed is empty,
+        room i also mirrors its feed into the shared memory "/<shared_feed>.<i>".
+        Unless recordings is empty, room i records its games into that directory
+        as "room<i>-<game>.rec". Unless input_traces is empty, room i appends
+        the actions of the players in its games to "<input_traces>/room<i>.trace".
+    */
+    RoomManager(
+        const std::vector<ServerParameters> &parameters,
+        std::size_t worker_count,
+        const SlowClientPolicy &slow_clients,
+        const std::string &shared_feed = {},
+        const std::string &recordings = {},
+        const std::string &input_traces = {}
+    );
+
+    RoomManager(const RoomManager&) = delete;
+    RoomManager &operator=(const RoomManager&) = delete;
+
+    ~RoomManager();
+
+    /* Hands the client over to a room. Thread-safe. */
+    void route(StreamSocket &&socket);
+
+    /*
+        Stops every room and returns what the next server needs to take them
+        over, in the order of the rooms. Waits for the games under way
+        to get between two turns -- at most the duration of a turn.
+    */
+    std::vector<GameRoom::Handover> hand_over();
+
+    /* Takes over the rooms of the previous server -- before any client is routed. */
+    void restore(std::vector<GameRoom::Handover> &&handovers);
+
+    std::size_t room_count() const {
+        return rooms.size();
+    }
+
+    /* Gathered from all the rooms. Thread-safe. */
+    const TurnStats &get_stats() const {
+        return stats;
+    }
+
+    const ConnectionStats &get_connection_stats() const {
+        return connection_stats;
+    }
+
+private:
+    static Task<void> admit(GameRoom &room, StreamSocket socket);
+    static Task<void> hand_over(GameRoom &room, std::promise<GameRoom::Handover> &promise);
+    static Task<void> restore(GameRoom &room, GameRoom::Handover &handover, std::promise<void> &promise);
+};
+
+} // namespace SK
+
+#endif // __SK_ROOM_MANAGER_H__
@@ -1,5 +1,5 @@
 /*
- * Clients connected to the server at any moment 
+ * Clients connected to a room at any moment
  * of an ONGOING game are divided into three classes:
  * 1) players -- clients who are taking actual
  *    part in the game, move their robots, etc.,
@@ -10,155 +10,426 @@
  *    to play. They might be players from
  *    a previous game.
  *
- * What happens during an ongoing game?
- *   The sockets corresponding to the players are stored in a vector,
- *   alongside information indicating whether they're still
- *   connected or not -- a disconnected client still technically
- *   takes part in the game, but no message is sent to or read from them.
- *
- *   The sockets corresponding to the observers are also stored in
- *   a vector. The only difference between them and the players is
- *   no message is attempted to be received from them. The reason
- *   for that is there is no point (from the perspective of performance)
- *   to waste time on making a syscall during the game, while handling
- *   the players efficiently is the main focus of the server.
- *   That is simply too expensive, especially considering a situation
- *   when such a client is notoriously sending big, yet still correct
- *   messages. It still can be detected when such a client disconnects,
- *   but whether they've sent an invalid message will only be learnt about
- *   afterwards.
+ * Threads
+ *   The rooms (GameRoom) are spread over a few worker threads (RoomManager),
+ *   each of them running an epoll-based EventLoop. Every client of a room
+ *   is served by two coroutines on the thread of the room: one listens to
+ *   the messages from the client, the other sends it what the room publishes.
+ *   No thread ever blocks on a single client.
  *
- *   The sockets corresponding to passive clients are ignored
- *   during the game. The server is trying neither reading from
- *   nor sending data over to them. However, this is not the case
- *   if the number of handled connections has not been reached yet.
- *   In a situation like that, another thread is going through
- *   the queue (check the section below to learn what the queue is),
- *   checking whether there are clients willing to join the game,
- *   and makes them observers. Do note here they have to receive
- *   information not only about the game having already been started,
- *   but also about every turn that has been taken in the game so far.
+ *   There's a special thread that works along the rooms -- the listener.
+ *   It sleeps until a connection is pending, accepts every connection
+ *   waiting in the backlog and routes each to a room with a free slot
+ *   in its lobby (or to any room, to be an observer there).
  *
  * What happens between games?
- *   When a game ends, the main thread (referred to by "the server" from
- *   now on in this section) is checking which players and observers have
- *   been disconnected and closes the corresponding sockets. The others
- *   are put into a queue where passive players are.
+ *   Every client in the lobby is watched by the EventLoop of its room, and
+ *   nothing is read from a client until its socket is readable -- so thousands
+ *   of idle clients cost nothing but their descriptors. Once a client has sent
+ *   something, all the complete messages in its buffer are parsed. A Join
+ *   makes the client a player if there are still free slots in the game,
+ *   the other valid messages are ignored and an invalid one disconnects it.
  *
- *   Then, the server takes one socket from the queue at a time, tries to
- *   fetch a message from it. If it does receive one, it parses it.
- *   If it's a Join message and there are still free slots in the game,
- *   it puts the socket into the vector of players. If it's another valid
- *   message, the server ignores it and put the socket back into the queue
- *   -- specifically at the end of it. If it's an invalid message,
- *   the server closes the socket.
+ *   A room admits the Joins in the order its EventLoop gets to them: each
+ *   time it wakes up, it resumes the clients of one epoll_wait() batch in
+ *   the order of the batch, and it handles a Join before it reads from
+ *   another client. Joins arriving close together may therefore be admitted
+ *   in another order than they arrived in. Clients routed to different
+ *   rooms are not ordered relative to each other at all -- they compete
+ *   for different lobbies anyway.
  *
- *   As soon as the number of required players has been reached, the server
- *   starts the game. Only other threads will be taking care of clients
- *   who want to join the game -- making them observers.
+ *   When a new player joins the lobby, a message AcceptedPlayer is published
+ *   to everyone in the room, including the new player (who also receives every
+ *   previous message so that they can learn who's waiting along them).
+ *   As soon as the number of required players has been reached, the room
+ *   starts the game.
  *
- *   When a new player joins the lobby, a message AcceptedPlayer has to be sent
- *   to everyone in the lobby, including the new player (who also receives every
- *   previous message so that they can learn who's waiting along them). An important
- *   note here is the messages about accepted players DO NOT have to be sent in the
- *   same order. It doesn't matter, at least from a player's perspective, if they
- *   joined the game as the first, or the second one. They just need to know who
- *   is in the lobby.
- *
- *   However, it is imperative all those messages have already been sent out when the server
+ *   It is imperative all those messages have already been sent out when the room
  *   decides to start a game by notifying the players and observers by a message GameStarted.
  *   Violating this invariant might lead to a client deciding to disconnect, assuming the server
- *   is not working properly -- and that is reasonable.
+ *   is not working properly -- and that is reasonable. It holds, as every client gets the
+ *   messages of the room in the order they have been published in.
+ *
+ * What happens during an ongoing game?
+ *   The room wakes up once a turn. Only the last action a player has sent
+ *   during the turn counts; the messages of observers and passive clients
+ *   are read and ignored. The turn is simulated and published, and the clients
+ *   are sent it as soon as their sockets take it -- one which falls too far
+ *   behind is dealt with according to the policy for slow clients.
+ *
+ *   A client who connects during the game becomes an observer and first
+ *   receives every message of the game so far, GameStarted included.
+ *
+ *   With --shared-feed, a room also mirrors every message it publishes into
+ *   a ring in shared memory (SharedRing), so that observers on the same host
+ *   read the game without a socket at all. They attach at any moment and start
+ *   with the messages published from then on; one lapped by the room resyncs.
  *
- * Responsibilities and tasks of threads
- *   The server is only taking care of updating the state of the game. It receives messages
- *   from the threads communicating with clients, and based on that, it simulates the game.
- *   Afterwards, it saves a message that's supposed to be sent to players and observers,
- *   notifies the threads they ought to send it, and waits for the next turn to end.
+ *   With --record, every game is also written to a file as it is sent out,
+ *   along with an index of its turns (GameRecorder). robots-replay serves
+ *   the recordings to observers, starting from any turn.
  *
- *   Threads managing players and observers work almost the same way. The only difference is
- *   those managin observers do not attempt to receive messages from the socket. This will
- *   be omitted in the analysis below for simplicity.
- *   The threads check if there are enough bytes in a buffer they store to parse them
- *   into a message. If so, they do and store it. Then they check if there has been a signal
- *   from the server they should hand over a message to it and if that's the case, they
- *   handle the request approprietly. Either way, then they attempt to read bytes from the client
- *   into the buffer. The sockets they use should have had timeout set to some value by the server
- *   so that the threads don't block and the value matches the game's conditions. Afterwards,
- *   they check if the server has sent a request to stop gathering data and send a message from it,
- *   or if the game has ended, in which he work is done.
+ *   With --input-trace, the rooms also keep the actions of the players of every
+ *   turn, along with the state of the generator a game starts with -- all it
+ *   takes to play the game again. --verify-trace replays such a trace on
+ *   the engine alone and checks that every message comes out the same.
+ *   --check-board does the same for the tiled board of huge games, against
+ *   the dense one.
  *
- * The listener
- *   There's a special thread that works along the server -- the listener. It accepts
- *   new connections and puts sockets corresponding to them into the queue of passive players.
+ * How is the server replaced?
+ *   With --handover, the server also listens on a control socket. A new server
+ *   started with the same one connects to it and takes over: every room stops
+ *   between two turns and the new server gets the listening sockets, the state
+ *   of the rooms and the sockets of their clients. It plays the games under way
+ *   again from the actions of their players -- which gives the very same messages --
+ *   and carries on from where the previous one has stopped. A client only
+ *   notices a turn a little late. The previous server exits then.
  *
 */
 
-#include <messages/client_messages.h>
-#include <messages/server_messages.h>
-#include <messages/serializer.h>
 #include <network/socket.h>
 #include <network/socket_options.h>
-#include <thread>
-#include <utilities/thread_pool.h>
-#include <utilities/thread_safe_queue.h>
+#include <network/unix_socket.h>
+#include <utilities/logger.h>
+#include <utilities/miscellaneous.h>
+#include <utilities/tracer.h>
+
+#include "handover.h"
+#include "headless.h"
+#include "random.h"
+#include "room_manager.h"
+#include "server_state.h"
 
-#include "messenger.h"
+#include <getopt.h> // getopt_long
 
-#include <array>
+#include <algorithm>    // std::clamp
 #include <atomic>
-#include <cstring>  // std::memmove
+#include <csignal>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>  // EXIT_FAILURE
 #include <optional>
 #include <span>
-#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include <iostream>
 
 using namespace SK;
 
-void listener_routine(ThreadSafeQueue<TCPSocket> &queue, TCPSocket &listener, std::atomic_bool &should_stop) {
+namespace {
+
+struct Options {
+    ServerParameters parameters{};
+    std::size_t rooms = 1;
+    std::size_t workers = std::thread::hardware_concurrency();
+    // Benchmarking the engine alone -- see run_headless().
+    bool headless = false;
+    std::size_t games = 1;
+    // How often the statistics of the turns are logged, in seconds -- never if 0.
+    std::uint64_t stats_interval = 0;
+    SlowClientPolicy slow_clients{};
+    // Where to write the trace of the threads to -- no tracing if empty.
+    std::string trace_path{};
+    // Where to listen for the local clients too -- '@' for the abstract namespace, nowhere if empty.
+    std::string unix_path{};
+    // The prefix of the shared memory the rooms mirror their feeds into -- none if empty.
+    std::string shared_feed{};
+    // The directory the games are recorded into, for robots-replay -- none if empty.
+    std::string recordings{};
+    // The directory the actions of the players are traced into -- none if empty.
+    std::string input_traces{};
+    // An input trace to replay on the engine alone, instead of serving -- see replay_input_trace().
+    std::string verify_trace{};
+    // Checking the tiled BitMatrix against the dense one, instead of serving -- see check_board().
+    bool check_board = false;
+    // The control socket the server is handed over through -- see hand_over(), none if empty.
+    std::string handover{};
+};
+
+SlowClientPolicy::Action parse_slow_client_action(const std::string &name) {
+    if (name == "flag")
+        return SlowClientPolicy::Action::FLAG;
+    if (name == "evict")
+        return SlowClientPolicy::Action::EVICT;
+    throw std::invalid_argument{"[parse_options] -S has to be one of: flag, evict."};
+}
+
+Options parse_options(int argc, char *argv[]) {
+    Options options{};
+    ServerParameters &parameters = options.parameters;
+    unsigned seen = 0;
+
+    const option long_options[] = {
+        {"bomb-timer",       required_argument, nullptr, 'b'},
+        {"players-count",    required_argument, nullptr, 'c'},
+        {"turn-duration",    required_argument, nullptr, 'd'},
+        {"explosion-radius", required_argument, nullptr, 'e'},
+        {"initial-blocks",   required_argument, nullptr, 'k'},
+        {"game-length",      required_argument, nullptr, 'l'},
+        {"server-name",      required_argument, nullptr, 'n'},
+        {"port",             required_argument, nullptr, 'p'},
+        {"seed",             required_argument, nullptr, 's'},
+        {"size-x",           required_argument, nullptr, 'x'},
+        {"size-y",           required_argument, nullptr, 'y'},
+        {"rooms",            required_argument, nullptr, 'r'},
+        {"workers",          required_argument, nullptr, 'w'},
+        {"headless",         no_argument,       nullptr, 'H'},
+        {"games",            required_argument, nullptr, 'g'},
+        {"stats-interval",   required_argument, nullptr, 'i'},
+        {"max-lag",          required_argument, nullptr, 'm'},
+        {"slow-clients",     required_argument, nullptr, 'S'},
+        {"trace",            required_argument, nullptr, 't'},
+        {"unix-socket",      required_argument, nullptr, 'u'},
+        {"shared-feed",      required_argument, nullptr, 'M'},
+        {"record",           required_argument, nullptr, 'R'},
+        {"input-trace",      required_argument, nullptr, 'I'},
+        {"verify-trace",     required_argument, nullptr, 'V'},
+        {"handover",         required_argument, nullptr, 'O'},
+        {"check-board",      no_argument,       nullptr, 'B'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "b:c:d:e:k:l:n:p:s:x:y:r:w:Hg:i:m:S:t:u:M:R:I:V:O:B", long_options, nullptr)) != -1) {
+        switch (option) {
+            case 'b': parameters.bomb_timer = parse_number<u16>(optarg, 'b'); break;
+            case 'c': parameters.players_count = parse_number<u8>(optarg, 'c'); break;
+            case 'd': parameters.turn_durations = parse_number<u64>(optarg, 'd'); break;
+            case 'e': parameters.explosion_radius = parse_number<u16>(optarg, 'e'); break;
+            case 'k': parameters.initial_blocks = parse_number<u16>(optarg, 'k'); break;
+            case 'l': parameters.game_length = parse_number<u16>(optarg, 'l'); break;
+            case 'n': parameters.server_name = String{optarg}; break;
+            case 'p': parameters.port = parse_number<u16>(optarg, 'p'); break;
+            case 's': parameters.seed = parse_number<u32>(optarg, 's'); break;
+            case 'x': parameters.size_x = parse_number<u16>(optarg, 'x'); break;
+            case 'y': parameters.size_y = parse_number<u16>(optarg, 'y'); break;
+            case 'r': options.rooms = parse_number<std::size_t>(optarg, 'r'); break;
+            case 'w': options.workers = parse_number<std::size_t>(optarg, 'w'); break;
+            case 'H': options.headless = true; continue;
+            case 'g': options.games = parse_number<std::size_t>(optarg, 'g'); continue;
+            case 'i': options.stats_interval = parse_number<std::uint64_t>(optarg, 'i'); continue;
+            case 'm': options.slow_clients.max_lag = parse_number<std::size_t>(optarg, 'm'); continue;
+            case 'S': options.slow_clients.action = parse_slow_client_action(optarg); continue;
+            case 't': options.trace_path = optarg; continue;
+            case 'u': options.unix_path = optarg; continue;
+            case 'M': options.shared_feed = optarg; continue;
+            case 'R': options.recordings = optarg; continue;
+            case 'I': options.input_traces = optarg; continue;
+            case 'V': options.verify_trace = optarg; continue;
+            case 'O': options.handover = optarg; continue;
+            case 'B': options.check_board = true; continue;
+            default:
+                throw std::invalid_argument{"[parse_options] Unknown option."};
+        }
+        seen |= 1u << (option - 'a');
+    }
+
+    // A trace carries the parameters of its games -- and the board check needs none but the seed.
+    if (!options.verify_trace.empty() || options.check_board)
+        return options;
+
+    // Neither a port nor the duration of a turn matters without the network.
+    for (const char required : {'b', 'c', 'd', 'e', 'k', 'l', 'n', 'p', 'x', 'y'})
+        if (!(options.headless && (required == 'p' || required == 'd' || required == 'n')) && !(seen & (1u << (required - 'a'))))
+            throw std::invalid_argument{std::string{"[parse_options] Missing option -"} + required + "."};
+    if (!parameters.players_count || !parameters.size_x || !parameters.size_y || !options.rooms)
+        throw std::invalid_argument{"[parse_options] The lobby and the board cannot be empty."};
+
+    return options;
+}
+
+/* Every room gets its own copy of the parameters -- and its own seed, if there is one. */
+std::vector<ServerParameters> room_parameters(const Options &options) {
+    std::vector<ServerParameters> result(options.rooms, options.parameters);
+    if (options.parameters.seed)
+        for (std::size_t i = 0; i < result.size(); ++i)
+            result[i].seed = static_cast<u32>(*options.parameters.seed + i);
+    return result;
+}
+
+std::atomic_bool should_stop = false;
+
+extern "C" void request_stop(int) {
+    should_stop = true;
+}
+
+} // anonymous namespace
+
+/* Returns the connection of the next server once it asks to take over, if there is a control socket. */
+std::optional<StreamSocket> listener_routine(
+    RoomManager &rooms,
+    std::span<StreamSocket* const> listeners,
+    StreamSocket *control,
+    std::atomic_bool &should_stop,
+    std::uint64_t stats_interval
+) {
+    using Clock = std::chrono::steady_clock;
+    // How long the listener sleeps at most, so that it notices it should stop.
+    constexpr auto max_wait = std::chrono::milliseconds{100};
+    const auto interval = std::chrono::seconds{stats_interval};
+    auto next_dump = Clock::now() + interval;
+
+    Tracer::instance().name_thread("listener");
+    Logger::instance().name_thread("listener");
+
+    std::vector<StreamSocket*> polled{listeners.begin(), listeners.end()};
+    if (control)
+        polled.push_back(control);
+
     while (!should_stop) {
-        if (auto sock = listener.accept()) {
-            queue.push(std::move(sock).value());
-            std::cout << "WHAAA\n";
+        auto wait = max_wait;
+        if (stats_interval)
+            wait = std::clamp(std::chrono::ceil<std::chrono::milliseconds>(next_dump - Clock::now()), std::chrono::milliseconds{0}, max_wait);
+
+        if (StreamSocket::wait_readable(polled, wait)) {
+            // The whole backlog at once -- the listening sockets are non-blocking.
+            for (StreamSocket *listener : listeners) {
+                while (auto sock = listener->accept()) {
+                    const TraceSpan span{"accept", "listener"};
+                    log_debug("accepted", {{"fd", sock->native_handle()}});
+                    rooms.route(std::move(sock).value());
+                }
+            }
+            if (control)
+                if (auto connection = control->accept())
+                    return connection;
+        }
+
+        if (stats_interval && Clock::now() >= next_dump) {
+            rooms.get_stats().log();
+            rooms.get_connection_stats().log();
+            next_dump += interval;
         }
-        else
-            std::this_thread::yield();
     }
+    return std::nullopt;
 }
 
-void run() {
-    Messenger messenger{1, 3};
-    ThreadSafeQueue<TCPSocket> passive_clients{};
-    std::atomic_bool should_stop = false;
-    ThreadPool tp{1};
-    TCPSocket listener_socket{};
-    listener_socket.set_socket_option(ReusePort{true});
-    listener_socket.bind(12345);
-    listener_socket.set_socket_blocking(false);
-    listener_socket.listen(5);
-    std::thread listener{listener_routine, std::ref(passive_clients), std::ref(listener_socket), std::ref(should_stop)};
-
-    // browse the queue until you get enough players
-    // start a game
-    // repeat
-    std::size_t player_count = 0;
-    while (player_count < 1) {
-        if (!passive_clients.empty()) {
-            auto sock = passive_clients.move_out();
-            messenger.add_player(ClientInfo(std::move(sock), "some name", "some addr"));
-            ++player_count;
-        } else {
-            std::this_thread::yield();
+void run(const Options &options) {
+    // Before the rooms are set up -- the previous server lets go of the shared memory and the recordings first.
+    std::optional<Takeover> takeover = std::nullopt;
+    if (!options.handover.empty())
+        takeover = take_over(options.handover);
+
+    RoomManager rooms{room_parameters(options), options.workers, options.slow_clients, options.shared_feed, options.recordings, options.input_traces};
+
+    std::optional<TCPSocket> listener_socket = std::nullopt;
+    std::optional<UnixSocket> local_socket = std::nullopt;
+    std::vector<StreamSocket*> listeners{};
+    if (takeover) {
+        // The very same sockets, so that no connection waiting in a backlog is lost.
+        for (StreamSocket &listener : takeover->listeners)
+            listeners.push_back(&listener);
+        rooms.restore(std::move(takeover->rooms));
+        log_info("taken_over", {{"listeners", listeners.size()}, {"rooms", rooms.room_count()}});
+    } else {
+        listener_socket.emplace();
+        listener_socket->set_socket_option(ReusePort{true});
+        listener_socket->bind(options.parameters.port);
+        listener_socket->set_socket_blocking(false);
+        listener_socket->listen(64);
+        listeners.push_back(&*listener_socket);
+
+        // The clients on the same host may skip the TCP stack -- they are routed to the very same rooms.
+        if (!options.unix_path.empty()) {
+            local_socket.emplace();
+            local_socket->bind(options.unix_path);
+            local_socket->set_socket_blocking(false);
+            local_socket->listen(64);
+            listeners.push_back(&*local_socket);
         }
     }
 
-    messenger.clear();
-    should_stop = true;
-    listener.join();
+    std::optional<UnixSocket> control = std::nullopt;
+    if (!options.handover.empty()) {
+        control.emplace();
+        control->bind(options.handover);
+        control->set_socket_blocking(false);
+        control->listen(1);
+    }
+
+    // The rooms run on their own threads, the listener only routes the newcomers to them.
+    auto connection = listener_routine(rooms, listeners, control ? &*control : nullptr, should_stop, options.stats_interval);
+    if (!connection)
+        return;
+
+    // Nobody else is to take over in the meantime.
+    control.reset();
+    log_info("handing_over", {{"rooms", rooms.room_count()}});
+    hand_over(UnixSocket{std::move(*connection)}, listeners, rooms.hand_over());
+}
+
+void run_benchmark(const Options &options) {
+    const HeadlessReport report = run_headless(options.parameters, options.games);
+    std::cout << "games: " << report.games
+              << ", turns: " << report.turns
+              << ", events: " << report.events
+              << ", time: " << report.seconds << " s\n"
+              << "turns/s: " << report.turns_per_second()
+              << ", events/s: " << report.events_per_second() << '\n';
+}
+
+/* Exits with a failure if any message has come out different -- a regression test of the engine. */
+bool run_trace_check(const Options &options) {
+    const HeadlessReport report = replay_input_trace(options.verify_trace);
+    std::cout << "games: " << report.games
+              << ", turns: " << report.turns
+              << ", events: " << report.events
+              << ", time: " << report.seconds << " s\n"
+              << "turns/s: " << report.turns_per_second()
+              << ", events/s: " << report.events_per_second() << '\n'
+              << "mismatched messages: " << report.mismatches;
+    if (report.first_mismatch)
+        std::cout << " (the first in game " << report.first_mismatch->first << ", turn " << report.first_mismatch->second << ')';
+    std::cout << '\n';
+    return report.mismatches == 0;
+}
+
+/* Exits with a failure if the tiled BitMatrix tells anything the dense one does not. */
+bool run_board_check(const Options &options) {
+    const std::uint32_t seed = options.parameters.seed ? *options.parameters.seed : get_seed();
+    const BoardCheckReport report = check_board(seed);
+    std::cout << "seed: " << seed
+              << ", operations: " << report.operations << '\n'
+              << "mismatches: " << report.mismatches;
+    if (!report.first_mismatch.empty())
+        std::cout << " (the first after " << report.first_mismatch << ')';
+    std::cout << '\n';
+    return report.mismatches == 0;
 }
 
-int main() {
-    run();
+int main(int argc, char *argv[]) {
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+
+    Logger::instance().start(std::clog);
+
+    try {
+        const Options options = parse_options(argc, argv);
+        if (!options.trace_path.empty())
+            Tracer::instance().start(options.trace_path);
+
+        bool passed = true;
+        if (!options.verify_trace.empty())
+            passed = run_trace_check(options);
+        else if (options.check_board)
+            passed = run_board_check(options);
+        else if (options.headless)
+            run_benchmark(options);
+        else
+            run(options);
+        Tracer::instance().stop();
+        if (!passed) {
+            Logger::instance().stop();
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception &e) {
+        Logger::instance().stop();
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    Logger::instance().stop();
 }
@@ -5,9 +5,7 @@
 #include <messages/network_string.h>
 
 #include <optional>
-#include <unordered_set>
 #include <vector>
-#include <utility>  // std::pair
 
 namespace SK {
 
@@ -22,27 +20,8 @@ struct IdleState {
     std::uint32_t seed;
 };
 
-struct GameState {
-    struct TurnInfo {
-        struct BombInfo {
-            std::pair<u32, u32> position;
-            u32 timeout;
-        };
-        
-        std::vector<std::pair<u32, u32>> positions;
-        std::vector<u32> death_count;
-        std::vector<BombInfo> bombs;
-        std::unordered_set<std::pair<u32, u32>> blocks;
-
-        std::vector<Event> events; // ...
-    };
-
-    std::vector<TurnInfo> turns;
-};
-
 struct ServerState {
     IdleState idle_state;
-    GameState game_state;
 };
 
 struct ServerParameters {
@@ -0,0 +1,125 @@
+#ifndef __SK_TURN_FEED_H__
+#define __SK_TURN_FEED_H__
+
+#include <messages/server_messages.h>
+#include <network/event_loop.h>
+#include <utilities/append_only_log.h>
+
+#include <algorithm>    // std::find_if
+#include <coroutine>
+#include <cstddef>      // std::byte
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace SK {
+
+/*
+    TurnFeed -- the log of messages broadcast to every client of a game,
+    along with the coroutines waiting for the next one to be published.
+
+    A message is kept together with its serialised bytes, so that it is
+    serialised once, when published, and not once for every client.
+
+    A waiting coroutine can also be woken up without a message, by cancel():
+    that is how a client gone in the meantime gets cleaned up at once, rather
+    than with the next message -- which may take long in an idle lobby.
+*/
+class TurnFeed {
+public:
+    struct Entry {
+        ServerMessage message;
+        std::vector<std::byte> bytes;
+    };
+
+    using Log = AppendOnlyLog<Entry>;
+
+private:
+    struct Waiter {
+        EventLoop *loop;
+        std::coroutine_handle<> handle;
+        const Log::Cursor *cursor;
+    };
+
+public:
+    class NextTurnAwaiter {
+    private:
+        TurnFeed &feed;
+        Log::Cursor &cursor;
+        EventLoop &loop;
+
+    public:
+        NextTurnAwaiter(TurnFeed &feed_, Log::Cursor &cursor_, EventLoop &loop_)
+        : feed{feed_}
+        , cursor{cursor_}
+        , loop{loop_} {}
+
+        bool await_ready() const {
+            return cursor.lag() > 0;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            const std::lock_guard<std::mutex> lock{feed.mutex};
+            // The message might have been published in the meantime.
+            if (cursor.lag() > 0)
+                return false;
+            feed.waiters.push_back(Waiter{&loop, handle, &cursor});
+            return true;
+        }
+
+        /* nullptr if the coroutine has been woken up by cancel(). */
+        const Entry *await_resume() {
+            return cursor.next();
+        }
+    };
+
+private:
+    Log log{};
+
+    std::mutex mutex{};
+    std::vector<Waiter> waiters{};
+
+public:
+    /* Must only be called from a single thread. */
+    const Entry &publish(ServerMessage &&message, std::vector<std::byte> &&bytes) {
+        const Entry &entry = log.emplace(Entry{std::move(message), std::move(bytes)});
+
+        std::vector<Waiter> ready{};
+        /* lock */ {
+            const std::lock_guard<std::mutex> lock{mutex};
+            ready.swap(waiters);
+        }
+        for (const Waiter &waiter : ready)
+            waiter.loop->post(waiter.handle);
+        return entry;
+    }
+
+    /* Wakes up the coroutine waiting with the cursor, if there is one, without a message. */
+    void cancel(const Log::Cursor &cursor) {
+        std::optional<Waiter> cancelled = std::nullopt;
+        /* lock */ {
+            const std::lock_guard<std::mutex> lock{mutex};
+            const auto it = std::find_if(waiters.begin(), waiters.end(), [&](const Waiter &waiter) {
+                return waiter.cursor == &cursor;
+            });
+            if (it == waiters.end())
+                return;
+            cancelled = *it;
+            waiters.erase(it);
+        }
+        cancelled->loop->post(cancelled->handle);
+    }
+
+    /* Suspends the coroutine until there is a message the cursor has not read yet. */
+    NextTurnAwaiter next_turn(Log::Cursor &cursor, EventLoop &loop) {
+        return NextTurnAwaiter{*this, cursor, loop};
+    }
+
+    const Log &messages() const {
+        return log;
+    }
+};
+
+} // namespace SK
+
+#endif // __SK_TURN_FEED_H__
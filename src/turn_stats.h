@@ -0,0 +1,51 @@
+#ifndef __SK_TURN_STATS_H__
+#define __SK_TURN_STATS_H__
+
+#include <utilities/histogram.h>
+#include <utilities/logger.h>
+
+#include <chrono>
+#include <cstdint>
+
+namespace SK {
+
+/*
+    TurnStats -- how long the stages of a turn take, in microseconds,
+    shared by all the rooms of the server. Each histogram is lock-free,
+    so the rooms record into them from their own threads.
+*/
+struct TurnStats {
+    Histogram<> jitter{};           // how late the turn has started compared to its deadline
+    Histogram<> input{};            // gathering the actions of the players for the engine
+    Histogram<> simulation{};       // the engine computing the turn
+    Histogram<> serialization{};    // serialising the turn, once for all the clients
+    Histogram<> delivery{};         // from publishing the turn to the last client's bytes being in its socket buffer
+
+    static std::uint64_t microseconds(std::chrono::steady_clock::duration duration) {
+        const auto count = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        return count > 0 ? static_cast<std::uint64_t>(count) : 0;
+    }
+
+    void log() const {
+        const auto stage = [](const auto &name, const Histogram<> &histogram) {
+            log_info("turn_stage", {
+                {"stage", name},
+                {"n", histogram.count()},
+                {"p50_us", histogram.percentile(0.5)},
+                {"p99_us", histogram.percentile(0.99)},
+                {"p999_us", histogram.percentile(0.999)},
+                {"max_us", histogram.max()}
+            });
+        };
+
+        stage("jitter", jitter);
+        stage("input", input);
+        stage("simulation", simulation);
+        stage("serialization", serialization);
+        stage("delivery", delivery);
+    }
+};
+
+} // namespace SK
+
+#endif // __SK_TURN_STATS_H__